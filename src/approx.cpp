@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 #include "approx.h"
 #include "lobatto.h"
 #include "gauss.h"
@@ -15,54 +16,143 @@ Approx::Approx()
 }
 
 
-
 //
-// Returns approximated value for "a <= x <= b".
+// Converts the intervals of the adaptive algorithm, stored in heap order,
+// into the array of intervals sorted by position.
 //
-double Approx::Get( double x ) const
+void Approx::Set( const Heap< HeapElt >& heap )
 {
-    for(size_t i = 0; i < m_heap.Size(); i++)
+    const size_t K = heap.Size();
+    assert( K > 0 );
+
+    std::vector< const HeapElt* > elt( K );
+    for( size_t k = 0; k < K; k++ )
+        elt[ k ] = &heap[ k ];
+
+    std::sort( elt.begin(), elt.end(),
+               []( const HeapElt* e1, const HeapElt* e2 ) { return e1->Left() < e2->Left(); } );
+
+    m_node.resize( K + 1 );
+    m_c1.resize( K );
+    m_c2.resize( K );
+    m_coefPos.resize( K + 1 );
+    m_coef.clear();
+
+    for( size_t k = 0; k < K; k++ )
     {
-        const HeapElt& e = m_heap[i];
-        if( e.Left() <= x && x <= e.Right() )
-        {
-            double val = 0;
+        const HeapElt& e = *elt[ k ];
 
-            // s - local variable for element "e"
-            const double s = e.Xinv(x);
+        // The intervals are obtained by bisection, hence they have common ends
+        assert( k == 0 || e.Left() == elt[ k - 1 ]->Right() );
 
-            for(size_t j = 0; j < e.CoefSize(); j++)
-                val += e.Coef( j ) * Lobatto::Basis(j, s);
+        m_node[ k ] = e.Left();
+        m_c1[ k ] = 0.5 * ( e.Right() + e.Left() );
+        m_c2[ k ] = 0.5 * ( e.Right() - e.Left() );
 
-            return val;
-        }
+        m_coefPos[ k ] = m_coef.size();
+        for( size_t j = 0; j < e.CoefSize(); j++ )
+            m_coef.push_back( e.Coef( j ) );
     }
+    m_node[ K ] = elt.back()->Right();
+    m_coefPos[ K ] = m_coef.size();
+}
 
-    assert(0);
-    return 0;
 
+//
+// Returns the interval containing "x". If "x" is a breakpoint, the interval
+// on the left side is returned.
+// The interval "hint" and its right neighbour are checked first, then binary search is used.
+// On return "hint" holds the interval found. The caller owns "hint", hence
+// the function changes no member and it can be called concurrently.
+//
+size_t Approx::Find( double x, size_t& hint ) const
+{
+    const size_t K = Size();
+    assert( m_node.front() <= x && x <= m_node.back() );
+
+    if( x <= m_node.front() )
+        return ( hint = 0 );
+
+    for( size_t k = hint; k < K && k <= hint + 1; k++ )
+    {
+        if( m_node[ k ] < x && x <= m_node[ k + 1 ] )
+            return ( hint = k );
+    }
+
+    const size_t k = std::lower_bound( m_node.begin() + 1, m_node.end(), x ) - ( m_node.begin() + 1 );
+
+    return ( hint = std::min( k, K - 1 ) );
 }
 
 
+//
+// Returns local variable "s" of interval "k" corresponding to global variable "x"
+//
+double Approx::Xinv( size_t k, double x ) const
+{
+    const double s = ( x - m_c1[ k ] ) / m_c2[ k ];
+
+    // Rounding errors, see HeapElt::Xinv
+    if( s < -1.0 )
+        return -1.0;
 
-std::vector< double > Approx::GetNode() const
+    if( s > 1.0 )
+        return 1.0;
+
+    return s;
+}
+
+
+//
+// Returns approximated value for "a <= x <= b".
+//
+double Approx::Get( double x ) const
+{
+    size_t hint = 0;
+    const size_t k = Find( x, hint );
+
+    // s - local variable for interval "k"
+    const double s = Xinv( k, x );
+
+    const double* c = Coef( k );
+    auto coef = [ c ]( size_t j ) { return c[ j ]; };
+    return Lobatto::Expand( Degree( k ), s, coef );
+}
+
+
+
+//
+// Returns approximated values val[i] for "n" points x[0], ..., x[n-1].
+// The interval is located once for the consecutive points lying in it.
+// The evaluation is efficient if the points are sorted.
+//
+void Approx::Get( const double* x, size_t n, double* val ) const
 {
-    std::vector< double > node;
+    // The interval found last, the search for the next run starts from it
+    size_t hint = 0;
 
-    for(size_t i = 0; i < m_heap.Size(); i++)
+    size_t i = 0;
+    while( i < n )
     {
-        const HeapElt& e = m_heap[i];
-        node.push_back( e.Left() );
-        node.push_back( e.Right() );
-    }
+        // Otherwise no point would be consumed (it also rejects NaN)
+        if( !( m_node.front() <= x[ i ] && x[ i ] <= m_node.back() ) )
+        {
+            throw std::runtime_error( "Point out of range in 'Approx::Get'" );
+        }
 
-    std::sort(node.begin(), node.end());
-    std::vector<double>::iterator newEnd;
-    newEnd = std::unique(node.begin(), node.end());
-    node.erase(newEnd, node.end());
+        // Interval containing point x[i]
+        const size_t k = Find( x[ i ], hint );
+        const double left = m_node[ k ];
+        const double right = m_node[ k + 1 ];
 
-    return node;
+        const size_t p = Degree( k );
+        const double* c = Coef( k );
+        auto coef = [ c ]( size_t j ) { return c[ j ]; };
 
+        // Following points in the same interval
+        for( ; i < n && left <= x[ i ] && x[ i ] <= right; i++ )
+            val[ i ] = Lobatto::Expand( p, Xinv( k, x[ i ] ), coef );
+    }
 }
 
 
@@ -78,13 +168,11 @@ size_t k, i;
 //        fprintf(out, " \t              c_%lu", static_cast<unsigned long>(k));
     fprintf(out, "\n");
 
-    for(i = 0; i < m_heap.Size(); ++i)
+    for(i = 0; i < Size(); ++i)
     {
-        const HeapElt& e = m_heap[i];
-
-        fprintf(out, "%4lu \t %16.6E \t %16.6E", static_cast<unsigned long>(i), e.Left(), e.Right() );
-        for(k = 0; k < e.CoefSize(); ++k)
-            fprintf(out, " \t %16.6E", e.Coef( k ) );
+        fprintf(out, "%4lu \t %16.6E \t %16.6E", static_cast<unsigned long>(i), m_node[i], m_node[i + 1] );
+        for(k = 0; k <= Degree( i ); ++k)
+            fprintf(out, " \t %16.6E", Coef( i )[ k ] );
         fprintf(out, "\n");
     }
 
@@ -26,21 +26,35 @@ public:
     virtual ~Approx() = default;
 
     virtual double Get( double x ) const;
+    virtual void Get( const double* x, size_t n, double* val ) const;
 
 
 
-    std::vector< double > GetNode() const;
+    std::vector< double > GetNode() const { return m_node; }
 
     void WriteCoef( FILE* out ) const;
 
-    void Set( const Heap< HeapElt >& heap )
-    {
-        m_heap = heap;
-    }
+    void Set( const Heap< HeapElt >& heap );
 
 private:
+    size_t Find( double x, size_t& hint ) const;
+    double Xinv( size_t k, double x ) const;
 
-    Heap< HeapElt > m_heap;
+    size_t Size() const { return m_c1.size(); }
+    size_t Degree( size_t k ) const { return m_coefPos[ k + 1 ] - m_coefPos[ k ] - 1; }
+    const double* Coef( size_t k ) const { return &m_coef[ m_coefPos[ k ] ]; }
+
+private:
+    // Breakpoints in ascending order, interval "k" is [m_node[k], m_node[k+1]]
+    std::vector< double > m_node;
+
+    // Coefficients of linear mapping for each interval, see HeapElt::Xinv
+    std::vector< double > m_c1, m_c2;
+
+    // Coefficients of all intervals stored one after another,
+    // coefficients of interval "k" start at position m_coefPos[k]
+    std::vector< double > m_coef;
+    std::vector< size_t > m_coefPos;
 };
 
 
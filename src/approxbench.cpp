@@ -0,0 +1,135 @@
+//
+// Micro-benchmark for class ApproxSolver.
+//
+// 1. Measures the number of solved systems of equations K c = b per second,
+//    where K is the matrix of the approximation problem, see file approxsolver.h.
+//    Three variants are compared:
+//        a) expert LAPACK driver called for each interval (ClpMtxBand::SolveSymPosChecked)
+//        b) factorization and solution for each interval (ClpMtxBand::SolveSymPos)
+//        c) one factorization shared by all intervals (ClpCholBand)
+//
+// 2. Measures the number of intervals solved per second by the adaptive
+//    algorithm ApproxSolver::Run for a model electron density.
+//
+// Usage: approxbench.x [degree]
+//
+// Zbigniew Romanowski [ROMZ@wp.pl]
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include "lobatto.h"
+#include "gauss.h"
+#include "approxsolver.h"
+#include "clpmtxband.h"
+#include "clpcholband.h"
+
+
+//
+// Model radial electron density of an atom with three shells
+//
+class ModelRho : public Fun1D
+{
+public:
+    double Get( double r ) const override
+    {
+        return r * r * ( 2E4 * exp( -70 * r ) + 1E2 * exp( -12 * r ) + exp( -2 * r ) );
+    }
+};
+
+
+//
+// Returns the elapsed time in seconds
+//
+static double Elapsed( const std::chrono::steady_clock::time_point& start )
+{
+    return std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+}
+
+
+int main( int argc, char* argv[] )
+{
+    const size_t deg = ( argc > 1 ) ? static_cast< size_t >( atoi( argv[ 1 ] ) ) : 8;
+    const size_t repeatNo = 200000;
+
+    if( deg < 2 )
+    {
+        printf( "Usage: approxbench.x [degree]    (degree >= 2)\n" );
+        return 1;
+    }
+
+    Lobatto lobatto( deg );
+    Gauss gauss( deg );
+
+    // Matrix K of the approximation problem, see ApproxSolver::Define
+    const size_t M = deg - 1;
+    ClpMtxBand k( M, 2, 0 );
+    for( size_t i = 0; i < M; i++ )
+    {
+        for( size_t j = i; j <= std::min( i + 2, M - 1 ); j++ )
+            k.Set( i, j ) = Lobatto::GetK( i + 2, j + 2 );
+    }
+
+    std::vector< double > b( M ), c( M );
+    double check = 0;
+
+    printf( "Degree: %zu\n\n", deg );
+    printf( "%-40s %15s\n", "Variant", "Solves/s" );
+
+    // a) Expert driver
+    auto start = std::chrono::steady_clock::now();
+    for( size_t n = 0; n < repeatNo; n++ )
+    {
+        for( size_t i = 0; i < M; i++ )
+            b[ i ] = 1.0 / ( n + i + 1 );
+        k.SolveSymPosChecked( b, c );
+        check += c[ 0 ];
+    }
+    printf( "%-40s %15.0f\n", "dpbsvx for each interval", repeatNo / Elapsed( start ) );
+
+    // b) Factorization for each interval
+    start = std::chrono::steady_clock::now();
+    for( size_t n = 0; n < repeatNo; n++ )
+    {
+        for( size_t i = 0; i < M; i++ )
+            b[ i ] = 1.0 / ( n + i + 1 );
+        k.SolveSymPos( b, c );
+        check += c[ 0 ];
+    }
+    printf( "%-40s %15.0f\n", "dpbtrf + dpbtrs for each interval", repeatNo / Elapsed( start ) );
+
+    // c) One factorization
+    start = std::chrono::steady_clock::now();
+    ClpCholBand chol;
+    chol.Factor( k );
+    for( size_t n = 0; n < repeatNo; n++ )
+    {
+        for( size_t i = 0; i < M; i++ )
+            b[ i ] = 1.0 / ( n + i + 1 );
+        chol.Solve( b, c );
+        check += c[ 0 ];
+    }
+    printf( "%-40s %15.0f\n", "one dpbtrf, dpbtrs for each interval", repeatNo / Elapsed( start ) );
+
+    // Adaptive approximation
+    const ModelRho rho;
+    ApproxSolver solver( deg, rho );
+    size_t runNo = 0;
+
+    start = std::chrono::steady_clock::now();
+    while( Elapsed( start ) < 1.0 )
+    {
+        solver.Run( 0, 50, 1E-9 );
+        runNo++;
+    }
+    const double t = Elapsed( start );
+
+    printf( "\n%-40s %15.0f\n", "ApproxSolver::Run intervals/s", solver.SolvedNo() / t );
+    printf( "%-40s %15zu\n", "Intervals per run", solver.SolvedNo() / runNo );
+    printf( "\n(checksum %g)\n", check );
+
+    return 0;
+}
@@ -4,6 +4,8 @@
 #include "funtilde.h"
 #include "lobatto.h"
 #include "gauss.h"
+#include "config.h"
+#include "eltkernel.h"
 
 
 // Constructor
@@ -12,6 +14,8 @@
 ApproxSolver::ApproxSolver( size_t M, const Fun1D& f )
     : m_M( M - 1 )
     , m_f( f )
+    , m_checked( Config::Get().m_symPosChecked )
+    , m_solvedNo( 0 )
 {
     assert( M >= 2 );
 
@@ -44,6 +48,10 @@ void ApproxSolver::Define( )
             m_K.Set( i, j ) = Lobatto::GetK( i + 2, j + 2 );
         }
     }
+
+    // Matrix K does not depend on the interval [a, b], see item 24 in the header file.
+    // Hence, it is factorized once for all intervals.
+    m_chol.Factor( m_K );
 }
 
 
@@ -85,6 +93,38 @@ Approx ApproxSolver::Run( double a, double b, double maxDelta )
 }
 
 
+//
+// Calculates the nodes a = r_0 < r_1 < .. r_N = b, such that approxiamtion error
+// for each interval [r_i, r_{i+1}] is less than "delta".
+// The adaptive algorithm starts from intervals [node_i, node_{i+1}], instead of
+// the single interval [a, b]. Hence, no heuristic divisions are forced.
+//
+Approx ApproxSolver::Run( const std::vector< double >& node, double maxDelta )
+{
+    assert( node.size() >= 2 );
+    m_heap.Clear();
+
+    for( size_t i = 0; i + 1 < node.size(); i++ )
+        Solve( node[ i ], node[ i + 1 ] );
+
+    while( m_heap.Top().Delta() >= maxDelta )
+    {
+        const HeapElt e = m_heap.Pop();
+
+        const double a = e.Left();
+        const double b = e.Right();
+        const double w = 0.5 * ( a + b );
+
+        Solve( a, w );
+        Solve( w, b );
+    }
+
+    Approx approx;
+    approx.Set( m_heap );
+    return approx;
+}
+
+
 //
 // Returns approximation coefficients
 //
@@ -116,12 +156,21 @@ void ApproxSolver::Solve( double a, double b )
 
     FunTilde funTilde( elt, m_f, a, b );
 
+    // Element of degree M has bubble functions \psi_2, ..., \psi_M at local positions 1, ..., M - 1
+    m_bLoc.resize( m_M + 2 );
+    EltKernel::Load( m_M + 1, funTilde.WVal(), &m_bLoc.front() );
+
     for( size_t i = 0; i < m_M; i++ )
     {
-        m_b[ i ] = funTilde.CalcB( i + 2 );
+        m_b[ i ] = m_bLoc[ i + 1 ];
     }
 
-    m_K.SolveSymPos( m_b, m_c );
+    if( m_checked )
+        m_K.SolveSymPosChecked( m_b, m_c );
+    else
+        m_chol.Solve( m_b, m_c );
+
+    m_solvedNo++;
 
 
     const double delta = CalcDelta( elt, funTilde );
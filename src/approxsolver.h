@@ -88,6 +88,10 @@
 //     Hence, there remained (M-1) basis functions!
 //     The matrix K, vectors b, c have dimension: (M-1)
 //
+// 24. Matrix K does not depend on the interval [a, b], since the Jacobian of mapping h
+//     is the common factor of matrix K and vector b. Hence, matrix K is factorized once
+//     and the factorization is reused for all intervals.
+//
 // Zbigniew Romanowski [ROMZ@wp.pl]
 //
 
@@ -97,6 +101,7 @@
 #include "heapelt.h"
 #include "fun1D.h"
 #include "clpmtxband.h"
+#include "clpcholband.h"
 #include "approx.h"
 #include "funtilde.h"
 
@@ -108,6 +113,10 @@ public:
     ~ApproxSolver() = default;
 
     Approx Run( double a, double b, double delta );
+    Approx Run( const std::vector< double >& node, double delta );
+
+    // Number of intervals for which the approximation problem was solved
+    size_t SolvedNo() const { return m_solvedNo; }
 
 private:
     void Define( );
@@ -123,15 +132,27 @@ private:
     // Searched approximation coefficients for one element
     std::vector< double > m_c;
 
+    // Local load vector for all basis functions, see class EltKernel
+    std::vector< double > m_bLoc;
+
     // Matrix of system of equations
     ClpMtxBand m_K;
 
+    // Cholesky factorization of matrix K
+    ClpCholBand m_chol;
+
     // Approximation degree
     const size_t m_M;
 
     // Approximated function
     const Fun1D& m_f;
 
+    // If "true", the expert LAPACK driver is used to solve the system of equations
+    const bool m_checked;
+
+    // Number of solved approximation problems
+    size_t m_solvedNo;
+
     // Heap
     Heap< HeapElt > m_heap;
 };
@@ -0,0 +1,91 @@
+#include <cassert>
+#include <stdexcept>
+#include "clpcholband.h"
+
+
+extern "C"
+{
+void dpbtrf_(char *uplo, int *n, int *kd, double *ab,
+    int *ldab, int *info);
+
+void dpbtrs_(char *uplo, int *n, int *kd, int *nrhs,
+    double *ab, int *ldab, double *b, int *ldb, int *info);
+}
+
+
+//
+// Constructor
+//
+ClpCholBand::ClpCholBand( )
+    : m_n( 0 )
+    , m_kd( 0 )
+    , m_factored( false )
+{
+}
+
+//
+// WRAPPER for "dpbtrf" procedure from LAPACK
+//
+// Cholesky factorization of symmetric, positive definite band matrix "a".
+// Matrix "a" is stored as upper triangular, and it is not modified.
+//
+void ClpCholBand::Factor( const ClpMtxBand& a )
+{
+    char uplo = 'U';
+    int n = static_cast< int >( a.ColNo() );
+    int kd = static_cast< int >( a.m_ku );
+    int ldab = kd + 1;
+    int info;
+
+    // Only "upper triangular" is defined
+    assert( a.m_kl == 0 );
+
+    m_u.assign( a.m_mtx.Head(), a.m_mtx.Head() + ldab * n );
+    m_n = a.ColNo();
+    m_kd = a.m_ku;
+    m_factored = false;
+
+    dpbtrf_( &uplo, &n, &kd, &m_u.front(), &ldab, &info );
+
+    if( info != 0 )
+    {
+        throw std::runtime_error( "Error in 'ClpCholBand::Factor'" );
+    }
+
+    m_factored = true;
+}
+
+//
+// Solves the set of linear equations A x = b
+//
+void ClpCholBand::Solve( const std::vector< double >& b, std::vector< double >& x ) const
+{
+    x = b;
+    Solve( x );
+}
+
+//
+// WRAPPER for "dpbtrs" procedure from LAPACK
+//
+// Solves the set of linear equations A x = b.
+// On input "x" holds the right hand side "b", on return it holds the solution.
+//
+void ClpCholBand::Solve( std::vector< double >& x ) const
+{
+    char uplo = 'U';
+    int n = static_cast< int >( m_n );
+    int kd = static_cast< int >( m_kd );
+    int ldab = kd + 1;
+    int nrhs = 1;
+    int info;
+
+    assert( m_factored );
+    assert( x.size() == m_n );
+
+    dpbtrs_( &uplo, &n, &kd, &nrhs, const_cast< double* >( &m_u.front() ), &ldab, &x.front(), &n, &info );
+
+    if( info != 0 )
+    {
+        throw std::runtime_error( "Error in 'ClpCholBand::Solve'" );
+    }
+}
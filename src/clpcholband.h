@@ -0,0 +1,52 @@
+#ifndef RATOM_CLPCHOLBAND_H
+#define RATOM_CLPCHOLBAND_H
+
+//
+// Cholesky factorization of symmetric, positive definite band matrix.
+//
+// 1. The matrix is factorized once by procedure "dpbtrf" from LAPACK:
+//        A = U^T U
+//    where U is upper triangular band matrix.
+//
+// 2. Then the set of linear equations A x = b is solved for any number of
+//    right hand sides by procedure "dpbtrs", i.e. by two triangular solves.
+//
+// 3. In contrast to the expert driver "dpbsvx" (see ClpMtxBand::SolveSymPos),
+//    there is no equilibration, no condition estimation and no iterative refinement.
+//
+// Zbigniew Romanowski [ROMZ@wp.pl]
+//
+
+#include <cstddef>
+#include <vector>
+#include "clpmtxband.h"
+
+
+class ClpCholBand
+{
+public:
+    ClpCholBand();
+    ~ClpCholBand() = default;
+
+    void Factor( const ClpMtxBand& a );
+    void Solve( const std::vector< double >& b, std::vector< double >& x ) const;
+    void Solve( std::vector< double >& x ) const;
+
+    bool IsFactored() const { return m_factored; }
+    size_t ColNo() const { return m_n; }
+
+private:
+    // Factor U stored in the LAPACK symmetric band format
+    std::vector< double > m_u;
+
+    // Number of columns
+    size_t m_n;
+
+    // Number of superdiagonals
+    size_t m_kd;
+
+    // "true" if the factorization is done
+    bool m_factored;
+};
+
+#endif
@@ -14,6 +14,10 @@ extern "C"
     int dsysv_(char *uplo, int *n, int *nrhs, double *a,
     int *lda, int *ipiv, double *b, int *ldb,
         double *work, int *lwork, int *info);
+
+    int dsyev_(char *jobz, char *uplo, int *n, double *a,
+        int *lda, double *w, double *work, int *lwork,
+        int *info);
 }
 
 
@@ -84,6 +88,14 @@ double* ClpMtx::Head( )
     return &m_array.front();
 }
 
+//
+// Returns pointer to the begining (head) of the matrix
+//
+const double* ClpMtx::Head( ) const
+{
+    return &m_array.front();
+}
+
 //
 // Solves set of linear equations
 //	(*)	A x = b
@@ -159,6 +171,40 @@ void ClpMtx::Dsysv( const std::vector< double > &b, std::vector< double > &x )
 
 
 
+//
+// DSYEV computes all eigenvalues and eigenvectors of a real symmetric matrix A.
+// Matrix A must be squared, only its upper triangle is referenced.
+//
+// w - [OUT] eigenvalues in ascending order.
+// On return matrix A holds orthonormal eigenvectors stored in columns.
+//
+void ClpMtx::Dsyev( std::vector< double > &w )
+{
+    char jobz = 'V';
+    char uplo = 'U';
+    int n = static_cast< int >( m_colNo );
+    int lda = n;
+    std::vector< double > work;
+    double tmp[ 2 ];
+    int lwork;
+    int info, ret;
+
+    assert( m_colNo == m_rowNo );
+
+    w.resize( n );
+
+    // Query for required memory
+    lwork = -1;
+    dsyev_( &jobz, &uplo, &n, Head(), &lda, &w.front(), tmp, &lwork, &info );
+    lwork = static_cast< int >( tmp[ 0 ] );
+
+    work.resize( lwork );
+    ret = dsyev_( &jobz, &uplo, &n, Head(), &lda, &w.front(), &work.front(), &lwork, &info );
+
+    if( ret != 0 || info != 0 )
+        throw std::runtime_error( "Error in 'ClpMtx::Dsyev'" );
+}
+
 //
 // Saves the matric into the file.
 // For debuging purposes.
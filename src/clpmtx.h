@@ -29,10 +29,12 @@ public:
 
     void Dgesv( const std::vector< double >& b, std::vector< double >& x );
     void Dsysv( const std::vector< double >& b, std::vector< double >& x );
+    void Dsyev( std::vector< double >& w );
 
     void Write( const char* path, bool rowId = true ) const;
 
     double* Head( );
+    const double* Head( ) const;
 
 private:
     size_t Elt( size_t row, size_t col ) const;
@@ -1,7 +1,12 @@
 #include <cassert>
 #include <cstdio>
+#include <cmath>
+#include <cfloat>
 #include <stdexcept>
+#include <algorithm>
+#include <random>
 #include "clpmtxband.h"
+#include "clpcholband.h"
 
 
 extern "C"
@@ -25,6 +30,22 @@ void dpbsvx_(char *fact, char *uplo, int *n, int *kd,
     int *ldafb, char *equed, double *s, double *b, int *
     ldb, double *x, int *ldx, double *rcond, double *ferr,
      double *berr, double *work, int *iwork, int *info);
+
+void dgbtrf_(int *m, int *n, int *kl, int *ku, double *ab,
+    int *ldab, int *ipiv, int *info);
+
+void dpbtrf_(char *uplo, int *n, int *kd, double *ab,
+    int *ldab, int *info);
+
+void dpbtrs_(char *uplo, int *n, int *kd, int *nrhs,
+    double *ab, int *ldab, double *b, int *ldb, int *info);
+
+void dstev_(char *jobz, int *n, double *d, double *e,
+    double *z, int *ldz, double *work, int *info);
+
+void dgbtrs_(char *trans, int *n, int *kl, int *ku, int *nrhs,
+    double *ab, int *ldab, int *ipiv, double *b, int *ldb,
+    int *info);
 }
 
 
@@ -247,24 +268,22 @@ void ClpMtxBand::EigenGen( size_t eigNo, double abstol, std::vector< double > &w
     // Upper triangles of A and B are stored;
     char uplo = 'U';
 
-    std::vector< double > q, work;
-    std::vector< int > iwork, ifail;
     int info;
 
     // Only "upper triangular" is defined
     assert( m_kl == 0 );
 
-
-    q.resize( n * n );
-    work.resize( 7 * n );
-    iwork.resize( 5 * n );
-    ifail.resize( iu );
+    // Workspaces are reused between calls
+    m_q.resize( n * n );
+    m_work.resize( 7 * n );
+    m_iwork.resize( 5 * n );
+    m_ifail.resize( n );
 
     dsbgvx_(&jobz, &range, &uplo, &n, &ka, &kb, m_mtx.Head(), &ldab,
-        b.m_mtx.Head(), &ldbb, &q.front(), &ldq, &vl,
+        b.m_mtx.Head(), &ldbb, &m_q.front(), &ldq, &vl,
         &vu, &il, &iu, &abstol, &m,
         &w.front(),
-        z.Head(), &ldz, &work.front(), &iwork.front(), &ifail.front(), &info);
+        z.Head(), &ldz, &m_work.front(), &m_iwork.front(), &m_ifail.front(), &info);
 
     if( info != 0 )
     {
@@ -272,6 +291,839 @@ void ClpMtxBand::EigenGen( size_t eigNo, double abstol, std::vector< double > &w
     }
 }
 
+//
+// Calculates a few the smallest eigenvalues and eigenvectors for generalized eigenvalue problem
+//
+//		A x = \lambda B x
+//
+//      where A, B are banded, symmetric and B is positive definite.
+// matrices A, B are given as upper triangles
+//
+// In contrast to EigenGen, only "eigNo" eigenvectors are stored
+// and no dense N x N matrix is allocated:
+//    a) eigenvalues are calculated by "dsbgvx" without eigenvectors,
+//    b) eigenvectors are calculated by inverse iteration with banded LU
+//       factorization of matrix (A - \sigma B).
+// The required memory is O(N * eigNo + N * band) instead of O(N * N).
+// Matrices A and B are NOT destroyed.
+//
+// eigNo  - [IN] number of the calculated smallest eigenvalues
+// abstol - [IN] The absolute error tolerance for the eigenvalues.
+// w - [OUT] vector of calculated einevalues. MUST be of size $N$.
+// z - [OUT] matrix of calculated eigenvectors. On return it has size $N x eigNo$.
+//           Eigenvectors are normalized such that z^T B z = I.
+// b - [IN]  matrix B, banded, symetric, positive definite
+//
+void ClpMtxBand::EigenGenThin( size_t eigNo, double abstol, std::vector< double > &w, ClpMtx& z, const ClpMtxBand& b )
+{
+    int m;
+    int n = static_cast< int >( m_mtx.ColNo() );
+    int ka = static_cast< int >( m_ku );
+    int ldab = ka + 1;
+    int kb = static_cast< int >( b.m_ku );
+    int ldbb = kb + 1;
+    int il = 1;
+    int iu = static_cast< int >( eigNo );
+    double vl = 0, vu = 0;
+
+    // Eigenvectors are not referenced by "dsbgvx"
+    char jobz = 'N';
+    char range = 'I';
+    char uplo = 'U';
+    int ldq = 1, ldz = 1;
+    double q, zz;
+    int info;
+
+    // Only "upper triangular" is defined
+    assert( m_kl == 0 );
+    assert( b.m_kl == 0 );
+
+    if( eigNo > m_mtx.ColNo() )
+    {
+        throw std::runtime_error( "Too many eigenvalues requested in 'ClpMtxBand::EigenGenThin'" );
+    }
+
+    // "dsbgvx" destroys its input matrices, so the copies are passed.
+    m_ab.assign( m_mtx.Head(), m_mtx.Head() + ldab * n );
+    m_bb.assign( b.m_mtx.Head(), b.m_mtx.Head() + ldbb * n );
+
+    m_work.resize( 7 * n );
+    m_iwork.resize( 5 * n );
+    m_ifail.resize( n );
+
+    dsbgvx_(&jobz, &range, &uplo, &n, &ka, &kb, &m_ab.front(), &ldab,
+        &m_bb.front(), &ldbb, &q, &ldq, &vl,
+        &vu, &il, &iu, &abstol, &m,
+        &w.front(),
+        &zz, &ldz, &m_work.front(), &m_iwork.front(), &m_ifail.front(), &info);
+
+    if( info != 0 || m != iu )
+    {
+        throw std::runtime_error( "Error in 'ClpMtxBand::EigenGenThin'" );
+    }
+
+    z.Assign( n, eigNo, 0 );
+    for( size_t k = 0; k < eigNo; k++ )
+    {
+        InverseIter( w[ k ], k, z, b );
+    }
+}
+
+//
+// Calculates a few the smallest eigenvalues and eigenvectors for generalized eigenvalue problem
+//
+//		A x = \lambda B x
+//
+// by shift-invert Lanczos method with full reorthogonalization and thick restart.
+//
+// 1. The shift \sigma must be less than the smallest eigenvalue. Then matrix (A - \sigma B)
+//    is positive definite, and it is factorized by banded Cholesky procedure "dpbtrf".
+//    If the factorization fails, then \sigma is not below the spectrum, and it is decreased.
+//
+// 2. The Lanczos method is applied to operator (A - \sigma B)^{-1} B, which is symmetric
+//    with respect to B-inner product. Its largest eigenvalues \theta correspond to
+//    the smallest eigenvalues of the original problem:
+//        \lambda = \sigma + 1 / \theta
+//
+// 3. The starting vector is the sum of columns of "z" (eigenvectors of the previous SCF iteration),
+//    if "z" has N rows. Otherwise it is a pseudo-random vector (the same for each call).
+//
+// 4. The dimension of the Krylov subspace is at most min(N, 2 * eigNo + 20). When it is reached,
+//    the subspace is restarted from the "eigNo + 10" (at most) Ritz vectors with the largest
+//    Ritz values and the last Lanczos vector (thick restart). The projected matrix is no longer
+//    tridiagonal, hence it is kept as a dense matrix, which is built from the coefficients
+//    of the reorthogonalization.
+//
+// 5. The iteration stops, when for all "eigNo" largest Ritz values the residual estimate
+//    |\beta_j s_{j,k}| is less than tol * \theta_k.
+//
+// 6. Lanczos may miss an eigenvalue, if the starting vector is (nearly) orthogonal to its eigenvector.
+//    Hence, the number of eigenvalues less than \mu (between the last accepted and the next Ritz value)
+//    is calculated from the inertia of (A - \mu B), see function CountBelow.
+//    The result is accepted only if it is equal to "eigNo".
+//
+// The required memory is O(N * band + N * eigNo). No dense N x N matrix is allocated.
+//
+// eigNo  - [IN] number of the calculated smallest eigenvalues
+// sigma  - [IN] shift, approximation of the smallest eigenvalue from below
+// tol    - [IN] relative tolerance for the Ritz values
+// maxStep - [IN] maximal total number of Lanczos steps (including restarts)
+// w - [OUT] vector of calculated eigenvalues. MUST be of size at least $eigNo$.
+// z - [IN/OUT] on input the starting vectors (see item 3), on output matrix of calculated eigenvectors
+//              of size $N x eigNo$. Eigenvectors are normalized such that z^T B z = I.
+// b - [IN]  matrix B, banded, symetric, positive definite
+//
+// Returns "false" if the method has not converged. Then "w" and "z" are undefined.
+//
+bool ClpMtxBand::EigenGenLanczos( size_t eigNo, double sigma, double tol, size_t maxStep, std::vector< double >& w, ClpMtx& z, const ClpMtxBand& b )
+{
+    typedef std::vector< double > Vec;
+
+    const size_t n = m_mtx.ColNo();
+    const size_t checkStep = 5;
+    const size_t maxDim = std::min( n, 2 * eigNo + 20 );
+    const size_t keepNo = eigNo + 10;
+
+    assert( m_kl == 0 );
+    assert( w.size() >= eigNo );
+
+    if( eigNo == 0 || eigNo >= n )
+        return false;
+
+    // The shift is moved down until (A - \sigma B) is positive definite
+    double delta = 1E-3 * std::max( 1.0, fabs( sigma ) );
+    size_t t = 0;
+    while( !FactorCholShifted( sigma, b, m_lu ) )
+    {
+        if( ++t > 30 )
+            return false;
+        sigma -= delta;
+        delta *= 2;
+    }
+
+    int nn = static_cast< int >( n );
+    int kd = static_cast< int >( std::max( m_ku, b.m_ku ) );
+    int ldab = kd + 1;
+    int nrhs = 1;
+    char uplo = 'U';
+    int info;
+
+    // Starting vector
+    Vec u( n, 0 ), bu;
+    if( z.RowNo() == n && z.ColNo() > 0 )
+    {
+        for( size_t k = 0; k < z.ColNo(); k++ )
+        {
+            for( size_t l = 0; l < n; l++ )
+                u[ l ] += z.Get( l, k );
+        }
+    }
+    else
+    {
+        std::minstd_rand gen( 1 );
+        std::uniform_real_distribution< double > dist( -1, 1 );
+        for( size_t l = 0; l < n; l++ )
+            u[ l ] = dist( gen );
+    }
+
+    b.MultSym( u, bu );
+    double nrm = 0;
+    for( size_t l = 0; l < n; l++ )
+        nrm += u[ l ] * bu[ l ];
+    nrm = sqrt( nrm );
+    if( !( nrm > 0 ) )
+        return false;
+
+    for( size_t l = 0; l < n; l++ )
+    {
+        u[ l ] /= nrm;
+        bu[ l ] /= nrm;
+    }
+
+    // Lanczos vectors, their products with B, and the projected matrix H = Q^T B (A - \sigma B)^{-1} B Q
+    std::vector< Vec > q, bq;
+    ClpMtx h( maxDim, maxDim );
+    Vec theta;
+
+    for( size_t step = 0; step < maxStep; step++ )
+    {
+        q.push_back( u );
+        bq.push_back( bu );
+        const size_t k = q.size();
+        const size_t j = k - 1;
+
+        // u = (A - \sigma B)^{-1} B q_j
+        u = bq.back();
+        dpbtrs_( &uplo, &nn, &kd, &nrhs, &m_lu.front(), &ldab, &u.front(), &nn, &info );
+        if( info != 0 )
+        {
+            throw std::runtime_error( "Error in 'ClpMtxBand::EigenGenLanczos'" );
+        }
+
+        // Full reorthogonalization, twice is enough.
+        // The coefficients define column "j" of the projected matrix.
+        Vec c( k, 0 );
+        for( size_t pass = 0; pass < 2; pass++ )
+        {
+            for( size_t i = 0; i < k; i++ )
+            {
+                double d = 0;
+                for( size_t l = 0; l < n; l++ )
+                    d += u[ l ] * bq[ i ][ l ];
+
+                for( size_t l = 0; l < n; l++ )
+                    u[ l ] -= d * q[ i ][ l ];
+
+                c[ i ] += d;
+            }
+        }
+
+        // After restart the leading part of H is diagonal (Ritz values), only the new column is set
+        for( size_t i = 0; i < k; i++ )
+            h.Set( i, j ) = h.Set( j, i ) = c[ i ];
+
+        b.MultSym( u, bu );
+        double bt = 0;
+        for( size_t l = 0; l < n; l++ )
+            bt += u[ l ] * bu[ l ];
+        bt = sqrt( fabs( bt ) );
+
+        const bool breakdown = ( bt <= DBL_EPSILON * fabs( c[ j ] ) ) || ( k == n );
+        const bool restart = ( k == maxDim );
+
+        // Ritz values and vectors of the projected matrix H_k
+        if( k >= eigNo && ( k % checkStep == 0 || breakdown || restart ) )
+        {
+            ClpMtx s( k, k );
+            for( size_t jj = 0; jj < k; jj++ )
+            {
+                for( size_t i = 0; i < k; i++ )
+                    s.Set( i, jj ) = h.Get( i, jj );
+            }
+            s.Dsyev( theta );
+
+            // The largest Ritz values are at the end, see "dsyev"
+            bool conv = true;
+            for( size_t i = 0; i < eigNo && conv; i++ )
+            {
+                const size_t col = k - 1 - i;
+                const double res = bt * fabs( s.Get( k - 1, col ) );
+                if( theta[ col ] <= 0 || ( !breakdown && res > tol * theta[ col ] ) )
+                    conv = false;
+            }
+
+            if( conv )
+            {
+                z.Assign( n, eigNo, 0 );
+                for( size_t i = 0; i < eigNo; i++ )
+                {
+                    const size_t col = k - 1 - i;
+                    w[ i ] = sigma + 1 / theta[ col ];
+                    for( size_t m = 0; m < k; m++ )
+                    {
+                        const double y = s.Get( m, col );
+                        for( size_t l = 0; l < n; l++ )
+                            z.Set( l, i ) += y * q[ m ][ l ];
+                    }
+                }
+
+                // The shift \mu is between the last accepted eigenvalue and the next one
+                double mu = w[ eigNo - 1 ] + 1E-3 * std::max( 1.0, fabs( w[ eigNo - 1 ] ) );
+                if( k > eigNo && theta[ k - 1 - eigNo ] > 0 )
+                    mu = std::min( mu, 0.5 * ( w[ eigNo - 1 ] + sigma + 1 / theta[ k - 1 - eigNo ] ) );
+
+                return ( CountBelow( mu, b ) == eigNo );
+            }
+
+            if( breakdown )
+                return false;
+
+            // Thick restart from the Ritz vectors with the largest Ritz values
+            if( restart )
+            {
+                const size_t p = std::min( keepNo, k - 1 );
+                std::vector< Vec > x( p, Vec( n, 0 ) ), bx( p, Vec( n, 0 ) );
+                for( size_t i = 0; i < p; i++ )
+                {
+                    const size_t col = k - 1 - i;
+                    for( size_t m = 0; m < k; m++ )
+                    {
+                        const double y = s.Get( m, col );
+                        for( size_t l = 0; l < n; l++ )
+                        {
+                            x[ i ][ l ] += y * q[ m ][ l ];
+                            bx[ i ][ l ] += y * bq[ m ][ l ];
+                        }
+                    }
+                }
+
+                q.swap( x );
+                bq.swap( bx );
+                h.Assign( maxDim, maxDim, 0 );
+                for( size_t i = 0; i < p; i++ )
+                    h.Set( i, i ) = theta[ k - 1 - i ];
+            }
+        }
+        else if( breakdown )
+        {
+            return false;
+        }
+
+        for( size_t l = 0; l < n; l++ )
+        {
+            u[ l ] /= bt;
+            bu[ l ] /= bt;
+        }
+    }
+
+    return false;
+}
+
+//
+// Returns the number of eigenvalues of A x = \lambda B x less than "mu".
+// By the Sylvester's law of inertia it is equal to the number of negative pivots
+// of the factorization (A - \mu B) = L D L^T. The factorization is done without pivoting
+// in the band of the matrix, a zero pivot is replaced by a small number.
+//
+size_t ClpMtxBand::CountBelow( double mu, const ClpMtxBand& b ) const
+{
+    const size_t n = m_mtx.ColNo();
+    const size_t kd = std::max( m_ku, b.m_ku );
+    const size_t ldab = kd + 1;
+
+    // Upper triangle of (A - \mu B) in the LAPACK symmetric band format:
+    // element (i, j), i <= j, is stored at position kd + i - j + j * ldab
+    std::vector< double > ab( ldab * n, 0 );
+    for( size_t j = 0; j < n; j++ )
+    {
+        for( size_t i = ( j > kd ? j - kd : 0 ); i <= j; i++ )
+            ab[ kd + i - j + j * ldab ] = Get( i, j ) - mu * b.Get( i, j );
+    }
+
+    size_t count = 0;
+    for( size_t k = 0; k < n; k++ )
+    {
+        double d = ab[ kd + k * ldab ];
+        if( d == 0 )
+            d = DBL_EPSILON * ( 1 + fabs( mu ) );
+
+        if( d < 0 )
+            count++;
+
+        const size_t iMax = std::min( n - 1, k + kd );
+        for( size_t i = k + 1; i <= iMax; i++ )
+        {
+            const double l = ab[ kd + k - i + i * ldab ] / d;
+            for( size_t j = i; j <= iMax; j++ )
+                ab[ kd + i - j + j * ldab ] -= l * ab[ kd + k - j + j * ldab ];
+        }
+    }
+
+    return count;
+}
+
+//
+// Cholesky factorization of matrix (A - \sigma B), stored in the LAPACK symmetric band format.
+// Returns "false" if matrix (A - \sigma B) is not positive definite,
+// i.e. if \sigma is not less than the smallest eigenvalue of A x = \lambda B x.
+//
+bool ClpMtxBand::FactorCholShifted( double sigma, const ClpMtxBand& b, std::vector< double >& chol ) const
+{
+    int n = static_cast< int >( m_mtx.ColNo() );
+    int kd = static_cast< int >( std::max( m_ku, b.m_ku ) );
+    int ldab = kd + 1;
+    char uplo = 'U';
+    int info;
+
+    chol.assign( ldab * n, 0 );
+    for( int j = 0; j < n; j++ )
+    {
+        for( int i = std::max( 0, j - kd ); i <= j; i++ )
+            chol[ kd + i - j + j * ldab ] = Get( i, j ) - sigma * b.Get( i, j );
+    }
+
+    dpbtrf_( &uplo, &n, &kd, &chol.front(), &ldab, &info );
+    if( info < 0 )
+    {
+        throw std::runtime_error( "Error in 'ClpMtxBand::FactorCholShifted'" );
+    }
+
+    return ( info == 0 );
+}
+
+//
+// Calculates a few the smallest eigenvalues and eigenvectors for generalized eigenvalue problem
+//
+//		A x = \lambda B x
+//
+// by Locally Optimal Block Preconditioned Conjugate Gradient (LOBPCG) method.
+// The method is iterative, and it starts from the block of vectors given in matrix "z".
+// Hence, it is efficient if good approximation of eigenvectors is known,
+// for example from the previous SCF iteration.
+//
+// For each eigenvector "k" the preconditioner is (A - shift_k B)^{-1},
+// where "shift_k" should be the approximation of the eigenvalue "k".
+// One preconditioner (A - \sigma B)^{-1} with \sigma below the smallest eigenvalue is not sufficient:
+// for the atoms the eigenvalues of core and valence states differ by orders of magnitude, hence
+// for the valence states the convergence factor (\lambda_k - \sigma) / (\lambda_{k+1} - \sigma) is close to one.
+// The factorizations are not reused in the next call either, since the matrix A of the next
+// SCF iteration differs, and (A' - shift_k B)^{-1} with the previous matrix A' is a poor preconditioner
+// near the eigenvalue. The banded LU factorizations cost less than the additional iterations
+// (for 36Kr LOBPCG needs on average 2.3 iterations with new factorizations, and 10.9 with reused ones).
+//
+// In each iteration the Rayleigh-Ritz procedure is applied in the subspace [X, W, P], where
+//    X - current approximation of eigenvectors,
+//    W - preconditioned residuals,
+//    P - directions from the previous iteration.
+//
+// The iteration stops when for all eigenpairs the relative residual
+//    ||A x - \lambda B x|| / ( ||A x|| + |\lambda| ||B x|| )
+// is less than "tol".
+//
+// eigNo   - [IN] number of the calculated smallest eigenvalues
+// tol     - [IN] tolerance for relative residuals
+// maxIter - [IN] maximal number of iterations
+// shift   - [IN] approximation of eigenvalues used by preconditioners
+// w - [OUT] vector of calculated eigenvalues. MUST be of size at least $eigNo$.
+// z - [IN/OUT] on input initial eigenvectors, on output calculated eigenvectors
+//              normalized such that z^T B z = I. It must be of size $N x eigNo$.
+// b - [IN]  matrix B, banded, symetric, positive definite
+//
+// Returns "false" if the method has not converged. Then "w" and "z" are undefined.
+//
+bool ClpMtxBand::EigenGenLobpcg( size_t eigNo, double tol, size_t maxIter, const std::vector< double >& shift,
+                                 std::vector< double >& w, ClpMtx& z, const ClpMtxBand& b )
+{
+    typedef std::vector< double > Vec;
+
+    const size_t n = m_mtx.ColNo();
+    const size_t m = eigNo;
+
+    assert( m_kl == 0 );
+    assert( z.RowNo() == n );
+    assert( z.ColNo() >= m );
+    assert( shift.size() >= m );
+    assert( w.size() >= m );
+
+    // Preconditioners
+    m_luBlock.resize( m );
+    m_ipivBlock.resize( m );
+    for( size_t k = 0; k < m; k++ )
+    {
+        FactorShifted( shift[ k ], b, m_luBlock[ k ], m_ipivBlock[ k ] );
+    }
+
+    std::vector< Vec > x( m, Vec( n ) ), r, p;
+    for( size_t k = 0; k < m; k++ )
+    {
+        for( size_t i = 0; i < n; i++ )
+            x[ k ][ i ] = z.Get( i, k );
+    }
+
+    for( size_t iter = 0; iter <= maxIter; iter++ )
+    {
+        // Search subspace [X, W, P]
+        std::vector< Vec > v( x ), bv;
+        v.insert( v.end(), r.begin(), r.end() );
+        v.insert( v.end(), p.begin(), p.end() );
+
+        const size_t xNo = BOrthonorm( v, bv, b, x.size() );
+        if( xNo < m )
+            return false;
+
+        // Rayleigh-Ritz procedure
+        const size_t dim = v.size();
+        std::vector< Vec > av( dim );
+        for( size_t j = 0; j < dim; j++ )
+            MultSym( v[ j ], av[ j ] );
+
+        ClpMtx h( dim, dim );
+        for( size_t j = 0; j < dim; j++ )
+        {
+            for( size_t i = 0; i <= j; i++ )
+            {
+                double d = 0;
+                for( size_t l = 0; l < n; l++ )
+                    d += v[ i ][ l ] * av[ j ][ l ];
+                h.Set( i, j ) = h.Set( j, i ) = d;
+            }
+        }
+
+        Vec theta;
+        h.Dsyev( theta );
+
+        // Ritz vectors X, their products AX, BX, and new directions P
+        std::vector< Vec > ax( m, Vec( n, 0 ) ), bx( m, Vec( n, 0 ) );
+        x.assign( m, Vec( n, 0 ) );
+        p.assign( m, Vec( n, 0 ) );
+        for( size_t k = 0; k < m; k++ )
+        {
+            for( size_t j = 0; j < dim; j++ )
+            {
+                const double y = h.Get( j, k );
+                for( size_t l = 0; l < n; l++ )
+                {
+                    x[ k ][ l ] += y * v[ j ][ l ];
+                    ax[ k ][ l ] += y * av[ j ][ l ];
+                    bx[ k ][ l ] += y * bv[ j ][ l ];
+                }
+
+                if( j >= xNo )
+                {
+                    for( size_t l = 0; l < n; l++ )
+                        p[ k ][ l ] += y * v[ j ][ l ];
+                }
+            }
+        }
+
+        if( xNo == dim )
+            p.clear();
+
+        // Residuals
+        bool conv = true;
+        r.assign( m, Vec( n ) );
+        for( size_t k = 0; k < m; k++ )
+        {
+            double rr = 0, aa = 0, bb = 0;
+            for( size_t l = 0; l < n; l++ )
+            {
+                r[ k ][ l ] = ax[ k ][ l ] - theta[ k ] * bx[ k ][ l ];
+                rr += r[ k ][ l ] * r[ k ][ l ];
+                aa += ax[ k ][ l ] * ax[ k ][ l ];
+                bb += bx[ k ][ l ] * bx[ k ][ l ];
+            }
+
+            if( sqrt( rr ) > tol * ( sqrt( aa ) + fabs( theta[ k ] ) * sqrt( bb ) ) )
+                conv = false;
+        }
+
+        if( conv )
+        {
+            for( size_t k = 0; k < m; k++ )
+            {
+                w[ k ] = theta[ k ];
+                for( size_t l = 0; l < n; l++ )
+                    z.Set( l, k ) = x[ k ][ l ];
+            }
+            return true;
+        }
+
+        // Preconditioned residuals W
+        for( size_t k = 0; k < m; k++ )
+        {
+            SolveShifted( m_luBlock[ k ], m_ipivBlock[ k ], b, r[ k ] );
+        }
+    }
+
+    return false;
+}
+
+//
+// B-orthonormalization of vectors "v" by the Gram-Schmidt procedure with reorthogonalization.
+// Vectors, which are (numerically) linearly dependent on the previous ones, are removed.
+//
+// v     - [IN/OUT] vectors to be orthonormalized
+// bv    - [OUT] products B v
+// first - [IN] the number of leading vectors in "v" which are counted
+//
+// Returns the number of kept vectors out of the "first" leading vectors.
+//
+size_t ClpMtxBand::BOrthonorm( std::vector< std::vector< double > >& v, std::vector< std::vector< double > >& bv, const ClpMtxBand& b, size_t first )
+{
+    const double eps = 1E-10;
+    std::vector< std::vector< double > > vOut, bvOut;
+    std::vector< double > bu;
+    size_t kept = 0;
+
+    for( size_t j = 0; j < v.size(); j++ )
+    {
+        std::vector< double >& u = v[ j ];
+        const size_t n = u.size();
+
+        b.MultSym( u, bu );
+        double nrm0 = 0;
+        for( size_t l = 0; l < n; l++ )
+            nrm0 += u[ l ] * bu[ l ];
+        nrm0 = sqrt( fabs( nrm0 ) );
+
+        if( nrm0 == 0 )
+            continue;
+
+        // Twice is enough
+        for( size_t pass = 0; pass < 2; pass++ )
+        {
+            for( size_t i = 0; i < vOut.size(); i++ )
+            {
+                double c = 0;
+                for( size_t l = 0; l < n; l++ )
+                    c += bvOut[ i ][ l ] * u[ l ];
+
+                for( size_t l = 0; l < n; l++ )
+                    u[ l ] -= c * vOut[ i ][ l ];
+            }
+        }
+
+        b.MultSym( u, bu );
+        double nrm = 0;
+        for( size_t l = 0; l < n; l++ )
+            nrm += u[ l ] * bu[ l ];
+        nrm = sqrt( fabs( nrm ) );
+
+        if( nrm < eps * nrm0 )
+            continue;
+
+        for( size_t l = 0; l < n; l++ )
+        {
+            u[ l ] /= nrm;
+            bu[ l ] /= nrm;
+        }
+
+        vOut.push_back( u );
+        bvOut.push_back( bu );
+
+        if( j < first )
+            kept++;
+    }
+
+    v.swap( vOut );
+    bv.swap( bvOut );
+
+    return kept;
+}
+
+//
+// Calculates eigenvector "eig" corresponding to the eigenvalue "lambda"
+// for generalized eigenvalue problem A x = \lambda B x by inverse iteration
+//
+//      (A - \sigma B) x_{k+1} = B x_k
+//
+// Shift \sigma is "lambda" moved slightly away, so matrix (A - \sigma B) is not singular.
+// The result is B-orthogonal to columns 0, 1, ..., eig-1 of matrix "z"
+// and it is stored in column "eig" of matrix "z".
+//
+void ClpMtxBand::InverseIter( double lambda, size_t eig, ClpMtx& z, const ClpMtxBand& b )
+{
+    const size_t maxIter = 10;
+    const double eps = 1E-13;
+    const size_t n = m_mtx.ColNo();
+
+    FactorShifted( lambda, b, m_lu, m_ipiv );
+
+    std::vector< double > x( n, 1.0 ), y( n ), bx( n );
+    for( size_t iter = 0; iter < maxIter; iter++ )
+    {
+        b.MultSym( x, y );
+        SolveShifted( m_lu, m_ipiv, b, y );
+
+        // B-orthogonalization against previously calculated eigenvectors
+        b.MultSym( y, bx );
+        for( size_t k = 0; k < eig; k++ )
+        {
+            double c = 0;
+            for( size_t i = 0; i < n; i++ )
+                c += z.Get( i, k ) * bx[ i ];
+
+            for( size_t i = 0; i < n; i++ )
+                y[ i ] -= c * z.Get( i, k );
+        }
+
+        // B-normalization
+        b.MultSym( y, bx );
+        double nrm = 0;
+        for( size_t i = 0; i < n; i++ )
+            nrm += y[ i ] * bx[ i ];
+        nrm = sqrt( nrm );
+
+        // Difference between subsequent iterations, independent of the sign
+        double diffP = 0, diffM = 0;
+        for( size_t i = 0; i < n; i++ )
+        {
+            y[ i ] /= nrm;
+            diffP = std::max( diffP, fabs( y[ i ] - x[ i ] ) );
+            diffM = std::max( diffM, fabs( y[ i ] + x[ i ] ) );
+        }
+
+        x.swap( y );
+        if( iter > 0 && std::min( diffP, diffM ) < eps )
+            break;
+    }
+
+    for( size_t i = 0; i < n; i++ )
+        z.Set( i, eig ) = x[ i ];
+}
+
+//
+// LU factorization of matrix (A - \sigma B), stored in the LAPACK general band format.
+// Shift \sigma is "lambda" moved slightly away, so matrix (A - \sigma B) is not singular.
+// If the shifted matrix happens to be exactly singular, the shift is increased.
+//
+// Matrix (A - \sigma B) is symmetric, but indefinite for all eigenvalues apart from the smallest one,
+// hence the banded Cholesky factorization can not be applied. LAPACK has no symmetric indefinite
+// factorization for band matrices, so the general band LU "dgbtrf" with partial pivoting is used.
+// Pivoting fills in "kd" extra superdiagonals, and the factor needs 3 * kd + 1 rows instead of kd + 1.
+// This is still O(N * band) memory (the band is at most a few tens), hence much less than the dense
+// N x N matrices replaced by the thin engine. The factor is reused for all iterations of one eigenvector.
+//
+void ClpMtxBand::FactorShifted( double lambda, const ClpMtxBand& b, std::vector< double >& lu, std::vector< int >& ipiv ) const
+{
+    int n = static_cast< int >( m_mtx.ColNo() );
+    int kd = static_cast< int >( std::max( m_ku, b.m_ku ) );
+    int ldlu = 3 * kd + 1;
+    int info = 1;
+
+    lu.resize( ldlu * n );
+    ipiv.resize( n );
+
+    double shift = 64 * DBL_EPSILON * std::max( 1.0, fabs( lambda ) );
+    for( size_t t = 0; t < 4 && info != 0; t++, shift *= 1000 )
+    {
+        const double sigma = lambda + shift;
+        std::fill( lu.begin(), lu.end(), 0 );
+        for( int j = 0; j < n; j++ )
+        {
+            const int iMin = std::max( 0, j - kd );
+            const int iMax = std::min( n - 1, j + kd );
+            for( int i = iMin; i <= iMax; i++ )
+            {
+                const size_t r = std::min( i, j ), c = std::max( i, j );
+                lu[ 2 * kd + i - j + j * ldlu ] = Get( r, c ) - sigma * b.Get( r, c );
+            }
+        }
+
+        dgbtrf_( &n, &n, &kd, &kd, &lu.front(), &ldlu, &ipiv.front(), &info );
+        if( info < 0 )
+        {
+            throw std::runtime_error( "Error in 'ClpMtxBand::FactorShifted'" );
+        }
+    }
+
+    if( info != 0 )
+    {
+        throw std::runtime_error( "Singular matrix in 'ClpMtxBand::FactorShifted'" );
+    }
+}
+
+//
+// Solves (A - \sigma B) x = y, where matrix (A - \sigma B) was factorized by FactorShifted.
+// On return vector "y" holds the solution.
+//
+void ClpMtxBand::SolveShifted( const std::vector< double >& lu, const std::vector< int >& ipiv, const ClpMtxBand& b, std::vector< double >& y ) const
+{
+    int n = static_cast< int >( m_mtx.ColNo() );
+    int kd = static_cast< int >( std::max( m_ku, b.m_ku ) );
+    int ldlu = 3 * kd + 1;
+    int nrhs = 1;
+    char trans = 'N';
+    int info;
+
+    dgbtrs_( &trans, &n, &kd, &kd, &nrhs, const_cast< double* >( &lu.front() ), &ldlu,
+        const_cast< int* >( &ipiv.front() ), &y.front(), &n, &info );
+
+    if( info != 0 )
+    {
+        throw std::runtime_error( "Error in 'ClpMtxBand::SolveShifted'" );
+    }
+}
+
+//
+// Multiplication of symmetric band matrix by vector: y = A x
+// Matrix A is stored as upper triangle.
+//
+void ClpMtxBand::MultSym( const std::vector< double >& x, std::vector< double >& y ) const
+{
+    const size_t n = m_mtx.ColNo();
+
+    assert( m_kl == 0 );
+    assert( x.size() == n );
+
+    y.assign( n, 0 );
+    for( size_t j = 0; j < n; j++ )
+    {
+        const size_t iMin = ( j > m_ku ) ? j - m_ku : 0;
+        for( size_t i = iMin; i < j; i++ )
+        {
+            const double a = m_mtx.Get( RowEx( i, j ), j );
+            y[ i ] += a * x[ j ];
+            y[ j ] += a * x[ i ];
+        }
+        y[ j ] += m_mtx.Get( RowEx( j, j ), j ) * x[ j ];
+    }
+}
+
+//
+// Returns the size (in bytes) of workspaces kept alive between calls
+//
+size_t ClpMtxBand::WorkMem() const
+{
+    const size_t d = m_q.size() + m_work.size() + m_ab.size() + m_bb.size() + m_lu.size();
+    const size_t i = m_iwork.size() + m_ifail.size() + m_ipiv.size();
+
+    return d * sizeof( double ) + i * sizeof( int );
+}
+
+//
+// It solves the set of linear equations:
+//		A x = b
+// $A$ is symmetric, positive definite.
+// $A$ is stored as upper triangular.
+//
+// By default, the lean Cholesky factorization and triangular solves are applied, see class ClpCholBand.
+// If the factorization is needed for many right hand sides, use class ClpCholBand directly.
+// If "checked" is "true", the expert driver "dpbsvx" is applied, see function SolveSymPosChecked.
+//
+void ClpMtxBand::SolveSymPos( const std::vector< double >& b, std::vector< double >& x, bool checked )
+{
+    if( checked )
+    {
+        SolveSymPosChecked( b, x );
+        return;
+    }
+
+    ClpCholBand chol;
+    chol.Factor( *this );
+    chol.Solve( b, x );
+}
+
 //
 // WRAPPER for "dpbsvx" procedure from LAPACK
 //
@@ -280,7 +1132,11 @@ void ClpMtxBand::EigenGen( size_t eigNo, double abstol, std::vector< double > &w
 // $A$ is symmetric, positive definite.
 // $A$ is stored as upper triangular.
 //
-void ClpMtxBand::SolveSymPos( const std::vector< double >& b, std::vector< double >& x )
+// The condition number is estimated, and the solution is iteratively refined.
+// Error is reported if matrix $A$ is singular to working precision.
+// Applied for diagnostics.
+//
+void ClpMtxBand::SolveSymPosChecked( const std::vector< double >& b, std::vector< double >& x )
 {
     char fact = 'N';  // The matrix A will be copied to AFB and factored.
     char equed = 'N'; // Specifies the form of equilibration that was done.
@@ -325,7 +1181,7 @@ void ClpMtxBand::SolveSymPos( const std::vector< double >& b, std::vector< doubl
 
     if( info != 0 )
     {
-        throw std::runtime_error( "Error in 'ClpMtxBand::Solve'" );
+        throw std::runtime_error( "Error in 'ClpMtxBand::SolveSymPosChecked'" );
     }
 }
 
@@ -13,6 +13,8 @@
 
 class ClpMtxBand
 {
+    friend class ClpCholBand;
+
 public:
     ClpMtxBand();
     ClpMtxBand( size_t n, size_t ku, size_t kl );
@@ -25,10 +27,18 @@ public:
 
     void Eigen( size_t eigNo, double abstol, std::vector< double >& w, ClpMtx& z );
     void EigenGen( size_t eigNo, double abstol, std::vector< double >& w, ClpMtx& z, ClpMtxBand& b );
+    void EigenGenThin( size_t eigNo, double abstol, std::vector< double >& w, ClpMtx& z, const ClpMtxBand& b );
+    bool EigenGenLanczos( size_t eigNo, double sigma, double tol, size_t maxStep, std::vector< double >& w, ClpMtx& z, const ClpMtxBand& b );
+    bool EigenGenLobpcg( size_t eigNo, double tol, size_t maxIter, const std::vector< double >& shift,
+                         std::vector< double >& w, ClpMtx& z, const ClpMtxBand& b );
+
+    void SolveSymPos( const std::vector< double >& b, std::vector< double >& x, bool checked = false );
+    void SolveSymPosChecked( const std::vector< double >& b, std::vector< double >& x );
 
-    void SolveSymPos( const std::vector< double >& b, std::vector< double >& x );
+    void MultSym( const std::vector< double >& x, std::vector< double >& y ) const;
 
     size_t ColNo() const;
+    size_t WorkMem() const;
 
 
     void Write(const char* path) const;
@@ -37,6 +47,13 @@ private:
     size_t RowEx( size_t row, size_t col ) const;
     bool InBand( size_t row, size_t col ) const;
 
+    void InverseIter( double lambda, size_t eig, ClpMtx& z, const ClpMtxBand& b );
+    void FactorShifted( double lambda, const ClpMtxBand& b, std::vector< double >& lu, std::vector< int >& ipiv ) const;
+    void SolveShifted( const std::vector< double >& lu, const std::vector< int >& ipiv, const ClpMtxBand& b, std::vector< double >& y ) const;
+    bool FactorCholShifted( double sigma, const ClpMtxBand& b, std::vector< double >& chol ) const;
+    size_t CountBelow( double mu, const ClpMtxBand& b ) const;
+    static size_t BOrthonorm( std::vector< std::vector< double > >& v, std::vector< std::vector< double > >& bv, const ClpMtxBand& b, size_t first );
+
 private:
     // Reactangular matrix used for string the band matrix
     ClpMtx m_mtx;
@@ -49,6 +66,25 @@ private:
 
     // Auxiliary mememer, works as "zero".
     double m_zero;
+
+    // Workspaces for LAPACK procedures.
+    // They are kept alive between calls, and they only grow.
+    std::vector< double > m_q;
+    std::vector< double > m_work;
+    std::vector< int > m_iwork;
+    std::vector< int > m_ifail;
+
+    // Copies of the matrices destroyed by "dsbgvx" in function EigenGenThin
+    std::vector< double > m_ab;
+    std::vector< double > m_bb;
+
+    // LU factorization of the shifted matrix (A - \sigma B) used by inverse iteration
+    std::vector< double > m_lu;
+    std::vector< int > m_ipiv;
+
+    // LU factorizations of (A - \sigma_k B) used as preconditioners by EigenGenLobpcg
+    std::vector< std::vector< double > > m_luBlock;
+    std::vector< std::vector< int > > m_ipivBlock;
 };
 
 #endif
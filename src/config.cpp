@@ -0,0 +1,201 @@
+#include "config.h"
+#include "paramdb.h"
+#include <stdexcept>
+#include <algorithm>
+
+// Initialization of static variable
+Config::Param Config::m_param;
+
+
+//
+// Constructor. Converts all input parameters and checks their values.
+//
+Config::Config( )
+{
+    Param& p = m_param;
+
+    // The largest admissible degree of element. Lobatto polynomials are generated
+    // up to the degree actually used, see "m_maxDeg".
+    const size_t maxDeg = 40;
+
+    p.m_proton = ParamDb::GetSize_t( "Atom_Proton" );
+    p.m_rc     = ParamDb::GetDouble( "Atom_Rc" );
+    Check( p.m_proton > 0, "Atom_Proton", "must be positive" );
+    Check( p.m_rc > 0, "Atom_Rc", "must be positive" );
+
+    p.m_exch = ParamDb::GetString( "XC_Exch" );
+    p.m_corr = ParamDb::GetString( "XC_Corr" );
+
+    // Parameters Rho0_c and Rho0_Alpha are needed only for the non-default initial density
+    p.m_rho0Default = ParamDb::GetBool( "Rho0_Default" );
+    if( p.m_rho0Default )
+    {
+        p.m_rho0C     = ParamDb::GetDouble( "Rho0_c", 0 );
+        p.m_rho0Alpha = ParamDb::GetDouble( "Rho0_Alpha", 0 );
+    }
+    else
+    {
+        p.m_rho0C     = ParamDb::GetDouble( "Rho0_c" );
+        p.m_rho0Alpha = ParamDb::GetDouble( "Rho0_Alpha" );
+    }
+
+    p.m_eigAdapt      = ParamDb::GetBool( "Solver_EigAdapt" );
+    p.m_eigNode       = ParamDb::GetSize_t( "Solver_EigNode" );
+    p.m_eigDeg        = ParamDb::GetSize_t( "Solver_EigDeg" );
+    p.m_eigAbsMaxCoef = ParamDb::GetDouble( "Solver_EigAbsMaxCoef" );
+    p.m_eigAbsTol     = ParamDb::GetDouble( "Solver_EigAbsTol" );
+    p.m_eigIterTol    = ParamDb::GetDouble( "Solver_EigIterTol", 1E-11 );
+    p.m_eigIterMax    = ParamDb::GetSize_t( "Solver_EigIterMax", 30 );
+    p.m_eigThreads    = ParamDb::GetSize_t( "Solver_EigThreads", 1 );
+    p.m_eigCoarsen    = ParamDb::GetSize_t( "Solver_EigCoarsen", 0 );
+    const std::string eigRefine = ParamDb::GetString( "Solver_EigRefine", "h" );
+    Check( eigRefine == "h" || eigRefine == "hp", "Solver_EigRefine", "must be 'h' or 'hp'" );
+    p.m_eigHp = ( eigRefine == "hp" );
+
+    const std::string eigEngine = ParamDb::GetString( "Solver_EigEngine", "dense" );
+    if( eigEngine == "dense" )
+        p.m_eigEngine = EigEngine_Dense;
+    else if( eigEngine == "thin" )
+        p.m_eigEngine = EigEngine_Thin;
+    else if( eigEngine == "lobpcg" )
+        p.m_eigEngine = EigEngine_Lobpcg;
+    else if( eigEngine == "lanczos" )
+        p.m_eigEngine = EigEngine_Lanczos;
+    else
+        Check( false, "Solver_EigEngine", "must be 'dense', 'thin', 'lobpcg' or 'lanczos'" );
+
+    Check( p.m_eigNode >= 2, "Solver_EigNode", "must be at least 2" );
+    Check( p.m_eigDeg >= 1 && p.m_eigDeg <= maxDeg, "Solver_EigDeg", "is out of range" );
+    Check( p.m_eigIterTol > 0, "Solver_EigIterTol", "must be positive" );
+    Check( p.m_eigIterMax > 0, "Solver_EigIterMax", "must be positive" );
+    Check( p.m_eigThreads > 0, "Solver_EigThreads", "must be positive" );
+
+    p.m_psnAdapt      = ParamDb::GetBool( "Solver_PsnAdapt" );
+    p.m_psnNode       = ParamDb::GetSize_t( "Solver_PsnNode" );
+    p.m_psnDeg        = ParamDb::GetSize_t( "Solver_PsnDeg" );
+    p.m_psnAbsMaxCoef = ParamDb::GetDouble( "Solver_PsnAbsMaxCoef" );
+    p.m_psnCache      = ParamDb::GetSize_t( "Solver_PsnCache", 64 );
+    Check( p.m_psnNode >= 2, "Solver_PsnNode", "must be at least 2" );
+    Check( p.m_psnDeg >= 1 && p.m_psnDeg <= maxDeg, "Solver_PsnDeg", "is out of range" );
+    Check( p.m_psnCache > 0, "Solver_PsnCache", "must be positive" );
+
+    const std::string psnMark = ParamDb::GetString( "Solver_PsnMark", "single" );
+    if( psnMark == "single" )
+        p.m_psnMark = PsnMark_Single;
+    else if( psnMark == "max" )
+        p.m_psnMark = PsnMark_Max;
+    else if( psnMark == "dorfler" )
+        p.m_psnMark = PsnMark_Dorfler;
+    else
+        Check( false, "Solver_PsnMark", "must be 'single', 'max' or 'dorfler'" );
+
+    p.m_psnMarkTheta = ParamDb::GetDouble( "Solver_PsnMarkTheta", 0.5 );
+    Check( p.m_psnMarkTheta > 0 && p.m_psnMarkTheta <= 1, "Solver_PsnMarkTheta", "must be in range (0, 1]" );
+
+    p.m_psnKeepMesh = ParamDb::GetBool( "Solver_PsnKeepMesh", false );
+    const std::string psnRefine = ParamDb::GetString( "Solver_PsnRefine", "h" );
+    Check( psnRefine == "h" || psnRefine == "hp", "Solver_PsnRefine", "must be 'h' or 'hp'" );
+    p.m_psnHp = ( psnRefine == "hp" );
+
+    p.m_hpMaxDeg = ParamDb::GetSize_t( "Solver_HpMaxDeg", 10 );
+    p.m_hpDecay  = ParamDb::GetDouble( "Solver_HpDecay", 0.5 );
+    Check( p.m_hpMaxDeg >= 1 && p.m_hpMaxDeg <= maxDeg, "Solver_HpMaxDeg", "is out of range" );
+    Check( p.m_hpDecay > 0 && p.m_hpDecay < 1, "Solver_HpDecay", "must be in (0, 1)" );
+
+    p.m_symPosChecked = ParamDb::GetBool( "Solver_SymPosChecked", false );
+
+    p.m_rhoDeg   = ParamDb::GetSize_t( "Rho_Deg" );
+    p.m_rhoDelta = ParamDb::GetDouble( "Rho_Delta" );
+    Check( p.m_rhoDeg >= 2 && p.m_rhoDeg <= maxDeg, "Rho_Deg", "is out of range" );
+    Check( p.m_rhoDelta > 0, "Rho_Delta", "must be positive" );
+
+    const std::string seed = ParamDb::GetString( "Rho_Seed", "mesh" );
+    Check( seed == "mesh" || seed == "eig", "Rho_Seed", "must be 'mesh' or 'eig'" );
+    p.m_rhoSeedEig = ( seed == "eig" );
+
+    p.m_scfMaxIter = ParamDb::GetSize_t( "Scf_MaxIter" );
+    p.m_scfMix     = ParamDb::GetDouble( "Scf_Mix" );
+    p.m_scfDiff    = ParamDb::GetDouble( "Scf_Diff" );
+    Check( p.m_scfMix > 0 && p.m_scfMix <= 1, "Scf_Mix", "must be in range (0, 1]" );
+    Check( p.m_scfDiff > 0, "Scf_Diff", "must be positive" );
+
+    const std::string mixEngine = ParamDb::GetString( "Scf_MixEngine", "linear" );
+    if( mixEngine == "linear" )
+        p.m_scfMixEngine = MixEngine_Linear;
+    else if( mixEngine == "pulay" )
+        p.m_scfMixEngine = MixEngine_Pulay;
+    else if( mixEngine == "anderson" )
+        p.m_scfMixEngine = MixEngine_Anderson;
+    else if( mixEngine == "broyden" )
+        p.m_scfMixEngine = MixEngine_Broyden;
+    else
+        Check( false, "Scf_MixEngine", "must be 'linear', 'pulay', 'anderson' or 'broyden'" );
+
+    p.m_scfMixHistory = ParamDb::GetSize_t( "Scf_MixHistory", 5 );
+    p.m_scfMixRestart = ParamDb::GetSize_t( "Scf_MixRestart", 0 );
+    Check( p.m_scfMixHistory > 0, "Scf_MixHistory", "must be positive" );
+
+    GetMesh( "Solver_EigMesh", p.m_eigMesh, p.m_eigMeshR0 );
+    GetMesh( "Solver_PsnMesh", p.m_psnMesh, p.m_psnMeshR0 );
+    GetMesh( "Rho_Mesh", p.m_rhoMesh, p.m_rhoMeshR0 );
+    p.m_rhoNode = ParamDb::GetSize_t( "Rho_Node", 16 );
+    Check( p.m_rhoNode >= 2, "Rho_Node", "must be at least 2" );
+
+    // The largest degree of element used by the solvers
+    p.m_maxDeg = std::max( p.m_eigDeg, std::max( p.m_psnDeg, p.m_rhoDeg ) );
+    if( p.m_eigHp || p.m_psnHp )
+        p.m_maxDeg = std::max( p.m_maxDeg, p.m_hpMaxDeg );
+
+    // The density projected from the eigenfunctions has twice the degree of their elements,
+    // see KohnSham::Project. Above "maxDeg" the density is not projected.
+    if( p.m_rhoSeedEig )
+    {
+        const size_t eltDeg = p.m_eigHp ? std::max( p.m_eigDeg, p.m_hpMaxDeg ) : p.m_eigDeg;
+        p.m_maxDeg = std::max( p.m_maxDeg, std::min( 2 * eltDeg, maxDeg ) );
+    }
+
+    p.m_outRhoNode = ParamDb::GetSize_t( "Out_RhoNode" );
+    p.m_outRhoPath = ParamDb::GetString( "Out_RhoPath" );
+    p.m_outEigNode = ParamDb::GetSize_t( "Out_EigNode" );
+    p.m_outEigPath = ParamDb::GetString( "Out_EigPath" );
+}
+
+
+//
+// Throws exception if the value of parameter "param" is not correct
+//
+void Config::Check( bool ok, const std::string& param, const std::string& what )
+{
+    if( !ok )
+    {
+        const std::string str = "Wrong value of parameter. Param = " + param + " " + what;
+        throw std::invalid_argument( str );
+    }
+}
+
+//
+// Reads the distribution of nodes of the initial mesh from parameter "param",
+// and defines the length of the first element "r0" (parameter Mesh_R0 or 1/Z).
+// Parameters Atom_Proton and Mesh_R0 must be read before.
+//
+void Config::GetMesh( const std::string& param, MeshType& type, double& r0 )
+{
+    const std::string str = ParamDb::GetString( param, "lin" );
+    const double meshR0 = ParamDb::GetDouble( "Mesh_R0", 1E-2 );
+    Check( meshR0 > 0, "Mesh_R0", "must be positive" );
+
+    r0 = meshR0;
+    if( str == "lin" )
+        type = MeshType_Lin;
+    else if( str == "exp" )
+        type = MeshType_Exp;
+    else if( str == "log" )
+        type = MeshType_Log;
+    else if( str == "atom" )
+    {
+        type = MeshType_Atom;
+        r0 = 1. / m_param.m_proton;
+    }
+    else
+        Check( false, param, "must be 'lin', 'exp', 'log' or 'atom'" );
+}
@@ -0,0 +1,162 @@
+#ifndef RATOM_CONFIG_H
+#define RATOM_CONFIG_H
+
+//
+// 1. Typed configuration of the calculations.
+//
+// 2. The input parameters are stored in the database ParamDb as strings.
+//    The conversion from string into the required type (and the search in the map)
+//    is too expensive to be done for each point of the radial mesh.
+//    Hence, all parameters are converted once, when the object of this class is created,
+//    and the functions of the solver read the typed values only.
+//
+// 3. The values are checked when they are converted. Exception std::invalid_argument
+//    is thrown for the first parameter with inadmissible value.
+//
+// 4. The object of this class must be created after the object of class ParamDb,
+//    and before any solver object, see class RAtom.
+//
+// 5. The meaning of the parameters is described in file doc/commands.txt.
+//
+// 6. The configuration is a global object read by function Config::Get(), as the tables
+//    of classes StateSet, Lobatto and Gauss. It is not passed into the solvers as an argument.
+//
+// Zbigniew Romanowski [ROMZ@wp.pl]
+//
+
+#include <cstddef>
+#include <string>
+#include "mesh.h"
+
+
+//
+// Engine used to solve the generalized eigenvalue problem (parameter Solver_EigEngine)
+//
+enum EigEngine
+{
+    EigEngine_Dense = 0, // "dsbgvx" from LAPACK, dense N x N matrix of eigenvectors
+    EigEngine_Thin,      // "dsbgvx" for eigenvalues, inverse iteration for eigenvectors, N x eigNo matrix
+    EigEngine_Lobpcg,    // LOBPCG started from the previous eigenvectors, "thin" engine as the fallback
+    EigEngine_Lanczos    // Shift-invert Lanczos, shift from the previous eigenvalues, "thin" engine as the fallback
+};
+
+//
+// Marking strategy of the adaptive Poisson solver (parameter Solver_PsnMark)
+//
+enum PsnMark
+{
+    PsnMark_Single = 0, // The element with the largest indicator
+    PsnMark_Max,        // The elements with indicator greater than theta times the largest one
+    PsnMark_Dorfler     // The elements with the largest indicators, which sum up to theta times the total
+};
+
+//
+// Mixing of electron densities in SCF procedure (parameter Scf_MixEngine)
+//
+enum MixEngine
+{
+    MixEngine_Linear = 0, // Linear mixing, see class RhoMix
+    MixEngine_Pulay,      // Pulay (DIIS) mixing, see class ScfMix
+    MixEngine_Anderson,   // Pulay mixing of the last two iterations
+    MixEngine_Broyden     // Modified Broyden mixing of D. D. Johnson
+};
+
+
+class Config
+{
+public:
+    struct Param
+    {
+        // Atom
+        size_t m_proton;
+        double m_rc;
+
+        // Exchange and correlation
+        std::string m_exch;
+        std::string m_corr;
+
+        // Initial electron density
+        bool m_rho0Default;
+        double m_rho0C;
+        double m_rho0Alpha;
+
+        // Eigenvalue problem
+        bool m_eigAdapt;
+        size_t m_eigNode;
+        size_t m_eigDeg;
+        double m_eigAbsMaxCoef;
+        double m_eigAbsTol;
+        EigEngine m_eigEngine;
+        double m_eigIterTol;
+        size_t m_eigIterMax;
+        size_t m_eigThreads;
+        size_t m_eigCoarsen;
+        bool m_eigHp;
+
+        // Poisson equation
+        bool m_psnAdapt;
+        size_t m_psnNode;
+        size_t m_psnDeg;
+        double m_psnAbsMaxCoef;
+        size_t m_psnCache;
+        PsnMark m_psnMark;
+        double m_psnMarkTheta;
+        bool m_psnKeepMesh;
+        bool m_psnHp;
+
+        // hp-adaptivity: the largest degree and the decay rate of coefficients below which
+        // the degree of element is increased instead of its division
+        size_t m_hpMaxDeg;
+        double m_hpDecay;
+
+        // The largest degree of element (Lobatto polynomials are generated up to this degree)
+        size_t m_maxDeg;
+
+        // Initial meshes: distribution of nodes and the length of the first element (see Mesh::Gen).
+        // The density approximation starts from "m_rhoNode" nodes, if the mesh is not uniform.
+        MeshType m_eigMesh;
+        MeshType m_psnMesh;
+        MeshType m_rhoMesh;
+        double m_eigMeshR0;
+        double m_psnMeshR0;
+        double m_rhoMeshR0;
+        size_t m_rhoNode;
+
+        // Systems of linear equations
+        bool m_symPosChecked;
+
+        // Approximation of electron density
+        size_t m_rhoDeg;
+        double m_rhoDelta;
+        bool m_rhoSeedEig;
+
+        // SCF procedure
+        size_t m_scfMaxIter;
+        double m_scfMix;
+        MixEngine m_scfMixEngine;
+        size_t m_scfMixHistory;
+        size_t m_scfMixRestart;
+        double m_scfDiff;
+
+        // Output
+        size_t m_outRhoNode;
+        std::string m_outRhoPath;
+        size_t m_outEigNode;
+        std::string m_outEigPath;
+    };
+
+public:
+    Config( );
+    ~Config( ) = default;
+
+    static const Param& Get( ) { return m_param; }
+
+private:
+    static void Check( bool ok, const std::string& param, const std::string& what );
+    static void GetMesh( const std::string& param, MeshType& type, double& r0 );
+
+private:
+    static Param m_param;
+};
+
+#endif
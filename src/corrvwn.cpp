@@ -1,5 +1,6 @@
 #include "corrvwn.h"
 #include <cmath>
+#include <cfloat>
 
 
 CorrVwn::CorrVwn(void)
@@ -50,7 +51,8 @@ double ec, vc;
 //
 void CorrVwn::Help(double rho, double* ec, double* vc) const
 {
-    if(rho == 0)
+    // For denormal density "Rs" overflows and "dx" is NaN
+    if(rho < DBL_MIN)
     {
         *ec = 0;
         *vc = 0;
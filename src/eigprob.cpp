@@ -7,7 +7,9 @@
 #include "eigprob.h"
 #include "lobatto.h"
 #include "gauss.h"
-#include "paramdb.h"
+#include "config.h"
+#include "clpcholband.h"
+#include "eltkernel.h"
 
 const double EigProb::m_gamma = 0.5;
 
@@ -16,45 +18,230 @@ const double EigProb::m_gamma = 0.5;
 //
 EigProb::EigProb( size_t ell )
     : m_ell( ell )
+    , m_adaptNo( 0 )
+    , m_passNo( 0 )
+    , m_locValid( false )
 {
 
-    const double rc      = ParamDb::GetDouble( "Atom_Rc" );
-    const size_t eigNode = ParamDb::GetSize_t( "Solver_EigNode" );
-    const size_t eigDeg  = ParamDb::GetSize_t( "Solver_EigDeg" );
+    const double rc      = Config::Get().m_rc;
+    const size_t eigNode = Config::Get().m_eigNode;
+    const size_t eigDeg  = Config::Get().m_eigDeg;
 
-    m_mesh.GenLin( 0, rc, eigNode, eigDeg );
+    m_mesh.Gen( Config::Get().m_eigMesh, 0, rc, eigNode, eigDeg, Config::Get().m_eigMeshR0 );
     m_mesh.CreateCnnt( BndrType_Dir, BndrType_Dir );
+
+    m_engine = Config::Get().m_eigEngine;
 }
 
 //
 // Solves the eigenproblem, WITHOUT adaptive procedure
 //
-void EigProb::Solve( const Fun1D& g, size_t eigNo )
+void EigProb::Solve( PotCache& pot, size_t eigNo )
 {
-    const double abstol = ParamDb::GetDouble( "Solver_EigAbsTol" );
+    const double abstol = Config::Get().m_eigAbsTol;
+
+    // Eigenvalues and eigenvectors from the previous call are the starting point for LOBPCG and Lanczos
+    const bool iterative = ( m_engine == EigEngine_Lobpcg ) || ( m_engine == EigEngine_Lanczos );
+    const bool warm = iterative && HasWarmStart( eigNo );
+    std::vector< double > shift;
+    if( warm )
+    {
+        shift.assign( m_w.begin(), m_w.begin() + eigNo );
+        Prolongate( eigNo );
+    }
+
+    // Previous eigenvalues define the shift for the Lanczos engine
+    const bool lanczos = ( m_engine == EigEngine_Lanczos ) && ( m_w.size() >= eigNo ) && ( eigNo > 0 );
+    double sigma = 0;
+    if( lanczos )
+    {
+        const double spread = m_w[ eigNo - 1 ] - m_w[ 0 ];
+        sigma = m_w[ 0 ] - std::max( 1E-2 * spread, 1E-3 * std::max( 1.0, fabs( m_w[ 0 ] ) ) );
+    }
 
     Malloc();
-    Assemble( g );
-    m_s.EigenGen(eigNo, abstol, m_w, m_z, m_o);
+    Assemble( pot );
+
+    const double iterTol  = Config::Get().m_eigIterTol;
+    if( lanczos )
+    {
+        // If not converged, the "thin" engine is applied.
+        // Matrices "m_s", "m_o" are not destroyed by the iterative engines.
+        // Lanczos is not applied if it needs more steps than a quarter of the space dimension.
+        // Without the warm start, Lanczos starts from a pseudo-random vector.
+        if( !warm )
+            m_z.Assign( 0, 0, 0 );
+
+        const size_t maxStep = std::max( eigNo + 1, m_w.size() / 4 );
+        if( m_s.EigenGenLanczos( eigNo, sigma, iterTol, maxStep, m_w, m_z, m_o ) )
+        {
+            m_zMesh = m_mesh;
+            return;
+        }
+    }
+
+    if( warm && m_engine == EigEngine_Lobpcg )
+    {
+        const size_t iterMax  = Config::Get().m_eigIterMax;
+
+        if( m_s.EigenGenLobpcg( eigNo, iterTol, iterMax, shift, m_w, m_z, m_o ) )
+        {
+            m_zMesh = m_mesh;
+            return;
+        }
+    }
+
+    if( m_engine == EigEngine_Dense )
+    {
+        m_z.Assign( m_w.size(), m_w.size(), 0 );
+        m_s.EigenGen( eigNo, abstol, m_w, m_z, m_o );
+    }
+    else
+    {
+        m_s.EigenGenThin( eigNo, abstol, m_w, m_z, m_o );
+    }
+
+    if( iterative )
+    {
+        m_zMesh = m_mesh;
+    }
+}
+
+//
+// Returns "true" if eigenvectors from the previous call of function Solve
+// can be used as the starting point for the iterative engine.
+//
+bool EigProb::HasWarmStart( size_t eigNo ) const
+{
+    if( m_zMesh.XNo() == 0 )
+        return false;
+
+    if( m_z.ColNo() < eigNo || m_w.size() < eigNo )
+        return false;
+
+    return ( m_z.RowNo() == m_zMesh.Dim( BndrType_Dir, BndrType_Dir ) );
+}
+
+//
+// Transfers eigenvectors "m_z" from the mesh "m_zMesh" onto the current mesh "m_mesh".
+//
+// On each element of the current mesh:
+//    a) coefficients of vertex functions are equal to the values of eigenfunction at the ends of element,
+//    b) coefficients of bubble functions are obtained by L2 projection of remaining part
+//       of eigenfunction onto bubble functions.
+// If "m_mesh" is the refinement of "m_zMesh", the eigenfunctions are represented exactly.
+//
+void EigProb::Prolongate( size_t eigNo )
+{
+    if( m_mesh.IsSame( m_zMesh ) )
+        return;
+
+    const size_t M = m_mesh.Dim( BndrType_Dir, BndrType_Dir );
+    ClpMtx z( M, eigNo );
+
+    ClpMtxBand k;
+    ClpCholBand chol;
+    size_t kDeg = 0;
+    std::vector< double > b, c, f( Gauss::Size() );
+
+    for( size_t n = 0; n < m_mesh.EltNo(); n++ )
+    {
+        const Element& e = m_mesh.Elt( n );
+        const size_t bubbleNo = e.P() - 1;
+
+        // Mass matrix for bubble functions, see class ApproxSolver
+        if( kDeg != e.P() )
+        {
+            kDeg = e.P();
+            k.Assign( bubbleNo, 2, 0, 0 );
+            for( size_t i = 0; i < bubbleNo; i++ )
+            {
+                const size_t jMax = std::min( i + 2, bubbleNo - 1 );
+                for( size_t j = i; j <= jMax; j++ )
+                    k.Set( i, j ) = Lobatto::GetK( i + 2, j + 2 );
+            }
+
+            // The same factorization is used for all eigenvectors and elements of the same degree
+            if( bubbleNo > 0 )
+                chol.Factor( k );
+        }
+
+        const double xa = m_mesh.X( n );
+        const double xb = m_mesh.X( n + 1 );
+
+        for( size_t eig = 0; eig < eigNo; eig++ )
+        {
+            const double fa = GetFun( m_zMesh, m_z, eig, xa );
+            const double fb = GetFun( m_zMesh, m_z, eig, xb );
+
+            if( e.m_dof.front() >= 0 )
+                z.Set( e.m_dof.front(), eig ) = fa;
+
+            if( e.m_dof.back() >= 0 )
+                z.Set( e.m_dof.back(), eig ) = fb;
+
+            if( bubbleNo == 0 )
+                continue;
+
+            const double* b0 = Gauss::Basis( 0 );
+            const double* b1 = Gauss::Basis( 1 );
+            for( size_t q = 0; q < f.size(); q++ )
+            {
+                const double s = Gauss::X( q );
+                f[ q ] = Gauss::W( q ) * ( GetFun( m_zMesh, m_z, eig, e.X( s ) ) - fa * b0[ q ] - fb * b1[ q ] );
+            }
+
+            b.assign( bubbleNo, 0 );
+            for( size_t i = 0; i < bubbleNo; i++ )
+            {
+                const double* bi = Gauss::Basis( i + 2 );
+                for( size_t q = 0; q < f.size(); q++ )
+                    b[ i ] += bi[ q ] * f[ q ];
+            }
+
+            chol.Solve( b, c );
+
+            // Bubble function "i" is stored at local position "i + 1", see Element::PsiId
+            for( size_t i = 0; i < bubbleNo; i++ )
+                z.Set( e.m_dof[ i + 1 ], eig ) = c[ i ];
+        }
+    }
+
+    m_z = z;
+    m_zMesh = m_mesh;
 }
 
 //
 // Solve the eigenproblem adatively
 //
-void EigProb::SolveAdapt( const Fun1D& g, size_t eigNo )
+void EigProb::SolveAdapt( PotCache& pot, size_t eigNo )
 {
-    const double absMaxCoef = ParamDb::GetDouble( "Solver_EigAbsMaxCoef" );
+    const double absMaxCoef = Config::Get().m_eigAbsMaxCoef;
+
+    const bool hp = Config::Get().m_eigHp;
+    const size_t maxDeg = Config::Get().m_hpMaxDeg;
 
     std::vector< EltInfo > eltInfo( eigNo );
-    std::vector< size_t > eltToSplit;
+    std::vector< size_t > eltToSplit, eltToRaise;
+    std::vector< bool > smooth;
+
+    // Every "coarsen" SCF iterations the elements, which are not needed any more, are joined
+    const size_t coarsen = Config::Get().m_eigCoarsen;
+    m_adaptNo++;
+    if( coarsen > 0 && m_adaptNo % coarsen == 0 )
+        Coarsen( eigNo );
 
+    // The potential is new, hence all local matrices must be calculated in the first step.
+    // In the next steps only the local matrices of divided elements are calculated.
+    m_locValid = false;
+    m_passNo = 0;
 
     while( true )
     {
-        Solve( g, eigNo );
+        Solve( pot, eigNo );
+        m_passNo++;
+        m_locValid = true;
         MaxMinCoef( eltInfo );
-        std::sort( eltInfo.begin(), eltInfo.end() );
-        const auto newEnd = std::unique( eltInfo.begin(), eltInfo.end() );
 
         double maxCoef = 0;
         for( size_t i = 0; i < eltInfo.size(); ++i )
@@ -63,22 +250,88 @@ void EigProb::SolveAdapt( const Fun1D& g, size_t eigNo )
                 maxCoef = eltInfo[i].GetMaxMinCoef();
         }
         if( maxCoef < absMaxCoef )
+        {
+            m_locValid = false;
             break;
+        }
+
+        // hp-adaptivity: the degree of element is increased, if the coefficients
+        // of all eigenfunctions which marked it decay fast
+        if( hp )
+        {
+            smooth.assign( m_mesh.EltNo(), true );
+            for( size_t i = 0; i < eltInfo.size(); ++i )
+            {
+                const size_t n = eltInfo[ i ].GetEltId();
+                smooth[ n ] = smooth[ n ] && IsSmooth( n, i );
+            }
+        }
+
+        std::sort( eltInfo.begin(), eltInfo.end() );
+        const auto newEnd = std::unique( eltInfo.begin(), eltInfo.end() );
 
         // The Elt was splitted
 
         eltToSplit.clear();
+        eltToRaise.clear();
         for( auto ii = eltInfo.begin(); ii != newEnd; ++ii )
         {
-            eltToSplit.push_back( ii->GetEltId() );
+            const size_t n = ii->GetEltId();
+            if( hp && smooth[ n ] && m_mesh.Elt( n ).P() < maxDeg )
+                eltToRaise.push_back( n );
+            else
+                eltToSplit.push_back( n );
         }
 
+        m_mesh.Raise( eltToRaise );
         m_mesh.AddToMesh( eltToSplit );
         m_mesh.CreateCnnt( BndrType_Dir, BndrType_Dir );
     }
 }
 
 
+//
+// Returns "true" if the coefficients of bubble functions of eigenfunction "eig"
+// on element "n" decay faster than Solver_HpDecay, see Lobatto::Decay.
+//
+bool EigProb::IsSmooth( size_t n, size_t eig ) const
+{
+    const Element& e = m_mesh.Elt( n );
+    std::vector< double > bubble( e.P() - 1 );
+
+    // Bubble function \psi_{j+1} is stored at local position "j"
+    for( size_t j = 1; j < e.DofNo() - 1; j++ )
+        bubble[ j - 1 ] = fabs( m_z.Get( e.m_dof[ j ], eig ) );
+
+    return Lobatto::Decay( bubble.data(), bubble.size() ) < Config::Get().m_hpDecay;
+}
+
+//
+// Joins the pairs of elements, which were obtained by division of one element,
+// if the bubble coefficients of all eigenfunctions (from the previous SCF iteration)
+// are far below Solver_EigAbsMaxCoef on both elements, see Mesh::Coarsen.
+// The indicator of element is the same as in function MaxMinCoef (see function MinCoef),
+// but the largest value for all eigenfunctions is taken.
+//
+void EigProb::Coarsen( size_t eigNo )
+{
+    // The eigenvectors must be calculated on the current mesh
+    if( m_z.ColNo() < eigNo || m_z.RowNo() != m_mesh.Dim( BndrType_Dir, BndrType_Dir ) )
+        return;
+
+    const size_t N = m_mesh.EltNo();
+
+    std::vector< double > ind( N, 0 );
+    for( size_t n = 0; n < N; n++ ) // For each element
+    {
+        for( size_t i = 0; i < eigNo; i++ ) // For each eigenfunction
+            ind[ n ] = std::max( ind[ n ], MinCoef( n, i ) );
+    }
+
+    if( m_mesh.Coarsen( ind, Config::Get().m_eigAbsMaxCoef ) > 0 )
+        m_mesh.CreateCnnt( BndrType_Dir, BndrType_Dir );
+}
+
 //
 // Allocates the required memory
 //
@@ -89,22 +342,72 @@ void EigProb::Malloc()
 
     m_s.Assign( M, band, 0, 0 );
     m_w.assign( M, 0 );
-    m_z.Assign( M, M, 0 );
     m_o.Assign( M, band, 0, 0 );
+
+    // Matrix of eigenvectors "m_z" is allocated by the engine in function Solve
 }
 
 //
 // Assembling algorithm for eigenvalue problem
 //
-void EigProb::Assemble( const Fun1D& g )
+void EigProb::Assemble( PotCache& pot )
 {
     const size_t N = m_mesh.EltNo(); // Number of elements
 
+    // Quadrature nodes and quadrature weights multiplied by the potential at these nodes
+    std::vector< double > r( Gauss::Size() ), wPot( Gauss::Size() );
+
+    // Local stiffness and overlap matrices of all elements of the current mesh
+    std::vector< double > sAll, kAll;
+    std::vector< size_t > pos( N + 1, 0 );
+
+    // Element of the previous mesh, which is compared with the current element
+    size_t old = 0;
+
     // Element loop
     for( size_t n = 0; n < N; n++ )
     {
         const Element& e = m_mesh.Elt( n );
         const size_t DofNo = e.DofNo();
+        const double a = m_mesh.X( n );
+        const double b = m_mesh.X( n + 1 );
+
+        pos[ n ] = sAll.size();
+        sAll.resize( pos[ n ] + DofNo * DofNo );
+        kAll.resize( pos[ n ] + DofNo * DofNo );
+        double* sLoc = &sAll[ pos[ n ] ];
+        double* kLoc = &kAll[ pos[ n ] ];
+
+        // Both meshes are sorted, hence the same element of the previous mesh is searched forward
+        bool found = false;
+        if( m_locValid )
+        {
+            while( old + 1 < m_locNode.size() && m_locNode[ old ] < a )
+                old++;
+
+            found = ( old + 1 < m_locNode.size() ) && ( m_locNode[ old ] == a ) && ( m_locNode[ old + 1 ] == b )
+                 && ( m_locPos[ old + 1 ] - m_locPos[ old ] == DofNo * DofNo );
+        }
+
+        if( found )
+        {
+            // The element was not divided, its local matrices are reused
+            std::copy( &m_sLoc[ m_locPos[ old ] ], &m_sLoc[ m_locPos[ old + 1 ] ], sLoc );
+            std::copy( &m_kLoc[ m_locPos[ old ] ], &m_kLoc[ m_locPos[ old + 1 ] ], kLoc );
+        }
+        else
+        {
+            // The potential is evaluated once per element, for all quadrature nodes at once.
+            // The values are shared by all "ell" and all adaptive steps, see class PotCache.
+            for( size_t q = 0; q < r.size(); q++ )
+                r[ q ] = e.X( Gauss::X( q ) );
+            pot.Get( a, b, &r.front(), &wPot.front() );
+
+            for( size_t q = 0; q < wPot.size(); q++ )
+                wPot[ q ] = Gauss::W( q ) * ( wPot[ q ] + m_ell * ( m_ell + 1 ) / ( 2 * r[ q ] * r[ q ] ) );
+
+            EltKernel::Eig( e.P(), &wPot.front(), e.Jac(), m_gamma, sLoc, kLoc );
+        }
 
         // Loop over basis functions
         for( size_t i = 0; i < DofNo; i++ )
@@ -113,99 +416,208 @@ void EigProb::Assemble( const Fun1D& g )
             if( ni < 0 )
                 continue;
 
-            const size_t psiI = e.PsiId( i );
-
             // Loop over basis functions
             for( size_t j = i; j < DofNo; j++ )
             {
-                const size_t psiJ = e.PsiId( j );
-
                 const int nj = e.m_dof[ j ];
                 if( nj > -1 )
                 {
-                    m_s.Set( ni, nj ) += CalcS( g, e, psiI, psiJ );
-                    m_o.Set( ni, nj ) += CalcK( e, psiI, psiJ );
+                    m_s.Set( ni, nj ) += sLoc[ i * DofNo + j ];
+                    m_o.Set( ni, nj ) += kLoc[ i * DofNo + j ];
                 }
             }
         }
     }
+    pos[ N ] = sAll.size();
+
+    // Local matrices are kept for the next step of the adaptive procedure
+    m_sLoc.swap( sAll );
+    m_kLoc.swap( kAll );
+    m_locPos.swap( pos );
+    m_locNode.resize( m_mesh.XNo() );
+    for( size_t i = 0; i < m_mesh.XNo(); i++ )
+        m_locNode[ i ] = m_mesh.X( i );
 }
 
 //
-// Returns the element (ni, nj) of the stiffness matrix element.
-// The elements are read from precomputed array.
+// Returns the value of $eig$ eigenfunction at point $r$
 //
-double EigProb::CalcS( const Fun1D& g, const Element& e, size_t ni, size_t nj ) const
+double EigProb::GetEigFun( size_t eig, double r ) const
 {
-    const double v1 = m_gamma * Lobatto::GetS( ni, nj );
-    double v0 = 0;
-
-    for( size_t n = 0; n < Gauss::Size(); n++ )
-    {
-        const double s = Gauss::X( n );
-        const double w = Gauss::W( n );
-        const double r = e.X( s );
-        v0 += w * Lobatto::Basis( ni, s ) * Lobatto::Basis( nj, s ) * GetPot( g, r );
-    }
+    assert( eig < m_w.size() );
 
-    const double jac = e.Jac();
-    return v1 / jac + v0 * jac;
+    return GetFun( m_mesh, m_z, eig, r );
 }
 
 //
-// For given $r$ it returns the value
-//    g(r) + L*(L + 1)/(2 r^2)
+// Returns the value at point $r$ of function defined on mesh "mesh"
+// by coefficients stored in column "eig" of matrix "z"
 //
-double EigProb::GetPot( const Fun1D& g, double r ) const
+double EigProb::GetFun( const Mesh& mesh, const ClpMtx& z, size_t eig, double r )
 {
-    assert( r > 0 );
-    const double a = g.Get( r );
-    const double b = m_ell * ( m_ell + 1 ) / ( 2 * r * r );
-    return a + b;
+    assert( mesh.IsInRange( r ) );
+
+    const size_t n = mesh.FindElt( r );
+    const Element& e = mesh.Elt( n );
+
+    // s - local variable for element "e"
+    const double s = e.Xinv( r );
+
+    // Sum over all basis function with support on the element $e$
+    auto coef = [ &e, &z, eig ]( size_t k )
+    {
+        const int mi = e.m_dof[ e.LocalId( k ) ];
+        return ( mi < 0 ) ? 0. : z.Get( mi, eig );
+    };
+
+    return Lobatto::Expand( e.P(), s, coef );
 }
 
+
+
+
 //
-// Returns the element $o[i][j]$ overlap matrix element
-// The elements are read from precomputed array.
+// Returns the values at points r[0], ..., r[n-1] of function defined on mesh "mesh"
+// by coefficients stored in column "eig" of matrix "z".
+// The element is located once for the consecutive points lying in it.
 //
-double EigProb::CalcK( const Element& e, size_t ni, size_t nj ) const
+void EigProb::GetFun( const Mesh& mesh, const ClpMtx& z, size_t eig, const double* r, size_t n, double* val )
 {
-    return e.Jac() * Lobatto::GetK( ni, nj );
-}
+    // The element found last, the search for the next run starts from it
+    size_t hint = 0;
 
+    size_t i = 0;
+    while( i < n )
+    {
+        // Otherwise no point would be consumed (it also rejects NaN)
+        if( !mesh.IsInRange( r[ i ] ) )
+        {
+            throw std::runtime_error( "Point out of range in 'EigProb::GetFun'" );
+        }
+
+        const size_t k = mesh.FindElt( r[ i ], hint );
+        const Element& e = mesh.Elt( k );
+        const double xa = mesh.X( k );
+        const double xb = mesh.X( k + 1 );
+
+        auto coef = [ &e, &z, eig ]( size_t j )
+        {
+            const int mi = e.m_dof[ e.LocalId( j ) ];
+            return ( mi < 0 ) ? 0. : z.Get( mi, eig );
+        };
+
+        // Following points in the same element
+        for( ; i < n && xa <= r[ i ] && r[ i ] <= xb; i++ )
+            val[ i ] = Lobatto::Expand( e.P(), e.Xinv( r[ i ] ), coef );
+    }
+}
 
 //
-// Returns the value of $eig$ eigenfunction at point $r$
+// Returns the values of $eig$ eigenfunction at points x[0], ..., x[n-1]
 //
-double EigProb::GetEigFun( size_t eig, double r ) const
+void EigProb::GetEigFun( size_t eig, const double* x, size_t n, double* val ) const
 {
     assert( eig < m_w.size() );
-    assert( m_mesh.IsInRange( r ) );
 
-    const size_t n = m_mesh.FindElt( r );
-    const Element& e = m_mesh.Elt( n );
+    GetFun( m_mesh, m_z, eig, x, n, val );
+}
 
-    // s - local variable for element "e"
-    const double s = e.Xinv( r );
+//
+// Returns the density
+//    rho(x) = \sum_k occ[k] R_k(x)^2,   k = 0, ..., eigNo - 1
+// at points x[0], ..., x[n-1], where R_k is the $k$ eigenfunction.
+// The element is located and the basis functions are evaluated once for
+// the consecutive points lying in the same element, then they are contracted
+// with the coefficients of all occupied eigenfunctions.
+//
+void EigProb::GetDensity( const double* occ, size_t eigNo, const double* x, size_t n, double* rho ) const
+{
+    assert( eigNo <= m_w.size() );
 
-    // Sum over all basis function with support on the element $e$
-    double val = 0;
+    std::vector< double > s, basis, rnl;
+
+    // The element found last, the search for the next run starts from it
+    size_t hint = 0;
 
-    for( size_t i = 0; i < e.m_dof.size(); i++ )
+    size_t i = 0;
+    while( i < n )
     {
-        const int mi = e.m_dof[ i ];
-        if( mi < 0 )
-            continue;
+        // Otherwise no point would be consumed (it also rejects NaN)
+        if( !m_mesh.IsInRange( x[ i ] ) )
+        {
+            throw std::runtime_error( "Point out of range in 'EigProb::GetDensity'" );
+        }
 
-        const size_t psiI = e.PsiId( i );
+        const size_t k = m_mesh.FindElt( x[ i ], hint );
+        const Element& e = m_mesh.Elt( k );
+        const double xa = m_mesh.X( k );
+        const double xb = m_mesh.X( k + 1 );
+
+        // Following points in the same element
+        s.clear();
+        for( size_t m = i; m < n && xa <= x[ m ] && x[ m ] <= xb; m++ )
+            s.push_back( e.Xinv( x[ m ] ) );
+
+        const size_t p = e.P();
+        const size_t pointNo = s.size();
+        basis.resize( ( p + 1 ) * pointNo );
+        rnl.resize( pointNo );
+        Lobatto::BasisAll( p, &s.front(), pointNo, &basis.front() );
+
+        double* v = rho + i;
+        std::fill( v, v + pointNo, 0. );
+        for( size_t eig = 0; eig < eigNo; eig++ )
+        {
+            if( occ[ eig ] <= 0 )
+                continue;
 
-        val += m_z.Get( mi, eig ) * Lobatto::Basis( psiI, s );
+            // Values of eigenfunction at the points of the element
+            std::fill( rnl.begin(), rnl.end(), 0. );
+            for( size_t j = 0; j <= p; j++ )
+            {
+                const int m = e.m_dof[ j ];
+                if( m < 0 )
+                    continue;
+
+                const double coef = m_z.Get( m, eig );
+                const double* b = &basis[ e.PsiId( j ) * pointNo ];
+                for( size_t q = 0; q < pointNo; q++ )
+                    rnl[ q ] += coef * b[ q ];
+            }
+
+            for( size_t q = 0; q < pointNo; q++ )
+                v[ q ] += occ[ eig ] * rnl[ q ] * rnl[ q ];
+        }
+
+        i += pointNo;
     }
-    return val;
 }
 
+//
+// Returns the dimension of the finite element space
+//
+size_t EigProb::Dim() const
+{
+    return m_w.size();
+}
 
+//
+// Returns memory (in bytes) used for eigenvectors and eigen-solver workspaces
+// (sizes of the stored arrays, not their capacities)
+//
+size_t EigProb::EigVecMem() const
+{
+    return m_z.RowNo() * m_z.ColNo() * sizeof( double ) + m_s.WorkMem();
+}
 
+//
+// Returns memory (in bytes) which would be used by the dense engine,
+// i.e. dense N x N matrices of eigenvectors and of the reduction to standard form.
+//
+size_t EigProb::EigVecMemDense() const
+{
+    return 2 * Dim() * Dim() * sizeof( double );
+}
 
 //
 // Returns the value of the $eig$ eigenvalue
@@ -254,11 +666,19 @@ void EigProb::WriteEigFun( const std::string& path, size_t eig, size_t pointNo )
     double x;
     for( size_t n = 0; n < m_mesh.XNo() - 1; n++ )
     {
+        const Element& e = m_mesh.Elt( n );
+
+        auto coef = [ this, &e, eig ]( size_t k )
+        {
+            const int mi = e.m_dof[ e.LocalId( k ) ];
+            return ( mi < 0 ) ? 0. : m_z.Get( mi, eig );
+        };
+
         x = m_mesh.X( n );
         const double dx = ( m_mesh.X( n + 1 ) - m_mesh.X( n ) ) / pointNo;
         for( size_t i = 0; i < pointNo; i++ )
         {
-            out  << x << " " << GetEigFun( eig, x ) << std::endl;
+            out  << x << " " << Lobatto::Expand( e.P(), e.Xinv( x ), coef ) << std::endl;
             x += dx;
         }
     }
@@ -270,6 +690,29 @@ void EigProb::WriteEigFun( const std::string& path, size_t eig, size_t pointNo )
 
 
 
+//
+// Returns the minimal absolute value of the coefficients of BUBBLE functions
+// of eigenfunction "eig" on element "n"
+//
+double EigProb::MinCoef( size_t n, size_t eig ) const
+{
+    const Element& e = m_mesh.Elt( n );
+    double minCoef = DBL_MAX;
+
+    for( size_t j = 1; j < e.DofNo() - 1; j++ ) // For each BUBBLE DOF at element
+    {
+        const int dof = e.m_dof[ j ];
+        if( dof < 0 ) // Skip Dirichlet boundary conditions
+            continue;
+
+        // Find the minimal coefficient for element "e"
+        const double coef = fabs( m_z.Get( dof, eig ) );
+        if( coef < minCoef )
+            minCoef = coef;
+    }
+    return minCoef;
+}
+
 //
 // Finds the element with the largest coefficient contained in the minimal coefficients
 // BUBBLE functins are considered only.
@@ -285,20 +728,7 @@ void EigProb::MaxMinCoef( std::vector< EltInfo >& eltInfo ) const
         eltInfo[ i ].Set( 0, -1 ); // Inicjalizacja
         for( size_t n = 0; n < m_mesh.EltNo(); n++ ) // For each element
         {
-            const Element& e = m_mesh.Elt( n );
-            minCoef = DBL_MAX;
-
-            for( size_t j = 1; j < e.DofNo() - 1; j++ ) // For each BUBBLE DOF at element
-            {
-                const int dof = e.m_dof[ j ];
-                if( dof < 0 ) // Skip Dirichlet boundary conditions
-                    continue;
-
-                // Find the minimal coefficient for element "e"
-                const double coef = fabs( m_z.Get( dof, i ) );
-                if( coef < minCoef )
-                    minCoef = coef;
-            }
+            minCoef = MinCoef( n, i );
 
             // Set the largest coefficient for the smallest coefficients
             if( minCoef > eltInfo[ i ].GetMaxMinCoef() )
@@ -6,7 +6,7 @@
 //
 //     -\gamma u''(r) + (g(r) + L*(L + 1)/(2 r^2) ) u(r) = \lambda u(r)
 //
-// 2. The function g is given.
+// 2. The function g is given. Its values at quadrature nodes are taken from class PotCache.
 //    Constant: \gamma = 0.5
 //    Parameter: L=0,1,2... is the angular quantum number
 //
@@ -45,7 +45,21 @@
 //    mesh $T'$ is obtained. The calculations are repeated for new mesh $T'$. The adaptive
 //    loop is repeated until coefficients $c^∗_i$ are less than prescribed value.
 //
-// 10. The implemented algorithm is described in my paper:
+// 10. If parameter Solver_EigRefine is "hp", the marked element is not split, but its degree
+//     is increased by one, if the coefficients of bubble functions of all eigenfunctions
+//     which marked it decay faster than Solver_HpDecay (see Lobatto::Decay),
+//     and its degree is less than Solver_HpMaxDeg.
+//
+// 11. The generalized eigenvalue problem is solved by one of the engines
+//     selected by parameter Solver_EigEngine, see enum EigEngine.
+//
+// 12. The iterative engines LOBPCG and Lanczos start from eigenvectors calculated in the previous call
+//     of function Solve. If the mesh was refined in the meantime, the eigenvectors are
+//     transfered onto the new mesh by function Prolongate. Since the new mesh is obtained
+//     by splitting elements or increasing their degrees, the eigenfunctions are represented
+//     exactly on the new mesh.
+//
+// 13. The implemented algorithm is described in my paper:
 //     Z. Romanowski:
 //     Application of h-adaptive, high order finite element method to solve radial Schrodinger equation,
 //     Molecular Physics, vol. 107, pp. 1339-1348  (2009).
@@ -60,10 +74,11 @@
 #include <string>
 #include "eltinfo.h"
 #include "fun1D.h"
-#include "eltinfo.h"
+#include "potcache.h"
 #include "clpmtxband.h"
 #include "clpmtx.h"
 #include "mesh.h"
+#include "config.h"
 
 
 class EigProb
@@ -72,24 +87,35 @@ public:
     EigProb( size_t ell );
     ~EigProb() = default;
 
-    void Solve( const Fun1D &g, size_t eigNo );
-    void SolveAdapt( const Fun1D& g, size_t eigNo );
+    void Solve( PotCache& pot, size_t eigNo );
+    void SolveAdapt( PotCache& pot, size_t eigNo );
 
     double GetEigVal( size_t eig ) const;
     double GetEigFun( size_t eig, double x ) const;
+    void GetEigFun( size_t eig, const double* x, size_t n, double* val ) const;
+    void GetDensity( const double* occ, size_t eigNo, const double* x, size_t n, double* rho ) const;
 
 
     void WriteEigFun( const std::string &path, size_t eig, size_t pointNo ) const;
 
+    size_t Dim() const;
+    size_t PassNo() const { return m_passNo; }
+    const Mesh& GetMesh() const { return m_mesh; }
+    size_t EigVecMem() const;
+    size_t EigVecMemDense() const;
+
 private:
     void Malloc();
-    void Assemble( const Fun1D &g );
+    void Assemble( PotCache& pot );
     void MaxMinCoef( std::vector< EltInfo >& eltInfo ) const;
+    double MinCoef( size_t n, size_t eig ) const;
+    void Coarsen( size_t eigNo );
+    bool IsSmooth( size_t n, size_t eig ) const;
 
-    double CalcS( const Fun1D& g, const Element& e, size_t ni, size_t nj ) const;
-    double CalcK( const Element& e, size_t ni, size_t nj ) const;
-
-    double GetPot( const Fun1D &g, double r ) const;
+    bool HasWarmStart( size_t eigNo ) const;
+    void Prolongate( size_t eigNo );
+    static double GetFun( const Mesh& mesh, const ClpMtx& z, size_t eig, double r );
+    static void GetFun( const Mesh& mesh, const ClpMtx& z, size_t eig, const double* r, size_t n, double* val );
 
 
 private:
@@ -110,6 +136,30 @@ private:
     // Angular quantum number
     const size_t m_ell;
 
+    // Engine for generalized eigenvalue problem
+    EigEngine m_engine;
+
+    // Mesh on which eigenvectors "m_z" were calculated
+    Mesh m_zMesh;
+
+    // Local stiffness and overlap matrices of all elements of the mesh, see function Assemble.
+    // The matrices of element "n" start at position m_locPos[n].
+    std::vector< double > m_sLoc, m_kLoc;
+    std::vector< size_t > m_locPos;
+
+    // Nodes of the mesh for which the local matrices were calculated
+    std::vector< double > m_locNode;
+
+    // Number of calls of function SolveAdapt
+    size_t m_adaptNo;
+
+    // Number of solutions in the last call of function SolveAdapt
+    size_t m_passNo;
+
+    // If "true", the local matrices were calculated for the current potential.
+    // Then, only the local matrices of new elements are calculated, see function SolveAdapt.
+    bool m_locValid;
+
     // Constant \gamma
     static const double m_gamma;
 };
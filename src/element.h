@@ -25,6 +25,7 @@ public:
     size_t P() const;
     size_t DofNo() const;
     size_t PsiId( size_t i ) const;
+    size_t LocalId( size_t k ) const;
 
     void Set( double x0, double x1, size_t p );
 
@@ -87,6 +88,22 @@ size_t Element::DofNo() const
     return m_dof.size();
 }
 
+//
+// Returns local index of basis function, which references Lobatto polynomial \psi_k.
+// This is the inverse of function PsiId.
+//
+inline
+size_t Element::LocalId( size_t k ) const
+{
+    if( k == 0 )
+        return 0;
+
+    if( k == 1 )
+        return P();
+
+    return k - 1;
+}
+
 //
 //
 // Jacobian
@@ -0,0 +1,86 @@
+//
+// Micro-benchmark for element kernels, see class EltKernel.
+//
+// For each element degree the number of assembled elements per second is measured
+// for the generic kernel (runtime loop bounds) and for the kernel specialized
+// for the given degree. The local stiffness and overlap matrices of the eigenvalue
+// problem and the local load vector (the same kernel in both cases) are evaluated for each element.
+//
+// Usage: eltbench.x
+//
+// Zbigniew Romanowski [ROMZ@wp.pl]
+//
+
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "lobatto.h"
+#include "gauss.h"
+#include "eltkernel.h"
+
+
+//
+// Returns the elapsed time in seconds
+//
+static double Elapsed( const std::chrono::steady_clock::time_point& start )
+{
+    return std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+}
+
+
+int main( )
+{
+    const size_t eltNo = 100000;
+    const size_t repNo = 5;
+
+    Lobatto lobatto( EltKernel::MAXP );
+    Gauss gauss( EltKernel::MAXP );
+
+    std::vector< double > wf( Gauss::Size() );
+    for( size_t q = 0; q < wf.size(); q++ )
+        wf[ q ] = Gauss::W( q ) * ( 1 + Gauss::X( q ) * Gauss::X( q ) );
+
+    const size_t D = EltKernel::MAXP + 1;
+    std::vector< double > s( D * D ), k( D * D ), b( D );
+    double check = 0;
+
+    printf( "%-8s %18s %18s %10s\n", "Degree", "Generic [elt/s]", "Special [elt/s]", "Speedup" );
+
+    for( size_t p = EltKernel::MINP; p <= EltKernel::MAXP; p++ )
+    {
+        // The best time of several repetitions is taken to reduce the noise
+        double tGeneric = 1E300, tSpecial = 1E300;
+
+        for( size_t rep = 0; rep < repNo; rep++ )
+        {
+            auto start = std::chrono::steady_clock::now();
+            for( size_t n = 0; n < eltNo; n++ )
+            {
+                const double jac = 1.0 + 1E-6 * n;
+                EltKernel::EigGeneric( p, &wf.front(), jac, 0.5, &s.front(), &k.front() );
+                EltKernel::Load( p, &wf.front(), &b.front() );
+                check += s[ 0 ] + k[ p ] + b[ p ];
+            }
+            tGeneric = std::min( tGeneric, Elapsed( start ) );
+
+            start = std::chrono::steady_clock::now();
+            for( size_t n = 0; n < eltNo; n++ )
+            {
+                const double jac = 1.0 + 1E-6 * n;
+                EltKernel::Eig( p, &wf.front(), jac, 0.5, &s.front(), &k.front() );
+                EltKernel::Load( p, &wf.front(), &b.front() );
+                check -= s[ 0 ] + k[ p ] + b[ p ];
+            }
+            tSpecial = std::min( tSpecial, Elapsed( start ) );
+        }
+
+        printf( "%-8zu %18.0f %18.0f %10.2f\n", p, eltNo / tGeneric, eltNo / tSpecial, tGeneric / tSpecial );
+    }
+
+    // Both kernels give the same results, hence the checksum should be (almost) zero
+    printf( "\n(checksum %g)\n", check );
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <cassert>
+#include "eltkernel.h"
+#include "lobatto.h"
+#include "gauss.h"
+
+
+//
+// Reorders matrices S and K into the local numbering
+//
+template< size_t P >
+EltKernel::LocalMtx< P >::LocalMtx()
+{
+    for( size_t i = 0; i <= P; i++ )
+    {
+        for( size_t j = 0; j <= P; j++ )
+        {
+            m_s[ i ][ j ] = Lobatto::GetS( Psi( P, i ), Psi( P, j ) );
+            m_k[ i ][ j ] = Lobatto::GetK( Psi( P, i ), Psi( P, j ) );
+        }
+    }
+}
+
+//
+// Local matrices for element of degree P.
+// The degree is known at compile time, hence the loops over basis functions have
+// fixed bounds and are unrolled by the compiler. The integrals of Lobatto polynomials
+// (matrices S and K) are reordered into the local numbering once, at the first call.
+//
+template< size_t P >
+void EltKernel::EigP( const double* wf, double jac, double gamma, double* s, double* k )
+{
+    constexpr size_t D = P + 1;
+    const size_t Q = Gauss::Size();
+
+    // Thread safe initialization of function-local static variable
+    static const LocalMtx< P > loc;
+
+    const double* b[ D ];
+    for( size_t i = 0; i < D; i++ )
+        b[ i ] = Gauss::Basis( Psi( P, i ) );
+
+    for( size_t i = 0; i < D; i++ )
+    {
+        for( size_t j = i; j < D; j++ )
+        {
+            double v0 = 0;
+            for( size_t n = 0; n < Q; n++ )
+                v0 += wf[ n ] * b[ i ][ n ] * b[ j ][ n ];
+
+            s[ i * D + j ] = gamma * loc.m_s[ i ][ j ] / jac + v0 * jac;
+            k[ i * D + j ] = jac * loc.m_k[ i ][ j ];
+        }
+    }
+}
+
+//
+// Local matrices for element of degree "p" with runtime loop bounds.
+//
+void EltKernel::EigGeneric( size_t p, const double* wf, double jac, double gamma, double* s, double* k )
+{
+    const size_t D = p + 1;
+    const size_t Q = Gauss::Size();
+
+    for( size_t i = 0; i < D; i++ )
+    {
+        const size_t psiI = Psi( p, i );
+        const double* bi = Gauss::Basis( psiI );
+
+        for( size_t j = i; j < D; j++ )
+        {
+            const size_t psiJ = Psi( p, j );
+            const double* bj = Gauss::Basis( psiJ );
+
+            double v0 = 0;
+            for( size_t n = 0; n < Q; n++ )
+                v0 += wf[ n ] * bi[ n ] * bj[ n ];
+
+            s[ i * D + j ] = gamma * Lobatto::GetS( psiI, psiJ ) / jac + v0 * jac;
+            k[ i * D + j ] = jac * Lobatto::GetK( psiI, psiJ );
+        }
+    }
+}
+
+//
+// Local load vector for element of degree "p".
+// Each entry is one contiguous dot product over the quadrature nodes,
+// hence the specialization on the degree gives nothing and one kernel is used for all degrees.
+//
+void EltKernel::Load( size_t p, const double* wf, double* b )
+{
+    const size_t D = p + 1;
+    const size_t Q = Gauss::Size();
+
+    for( size_t i = 0; i < D; i++ )
+    {
+        const double* bi = Gauss::Basis( Psi( p, i ) );
+
+        double v = 0;
+        for( size_t n = 0; n < Q; n++ )
+            v += wf[ n ] * bi[ n ];
+
+        b[ i ] = v;
+    }
+}
+
+//
+// Dispatches to the kernel specialized for degree "p".
+//
+void EltKernel::Eig( size_t p, const double* wf, double jac, double gamma, double* s, double* k )
+{
+    switch( p )
+    {
+        case 2:  EigP< 2 >( wf, jac, gamma, s, k ); break;
+        case 3:  EigP< 3 >( wf, jac, gamma, s, k ); break;
+        case 4:  EigP< 4 >( wf, jac, gamma, s, k ); break;
+        case 5:  EigP< 5 >( wf, jac, gamma, s, k ); break;
+        case 6:  EigP< 6 >( wf, jac, gamma, s, k ); break;
+        case 7:  EigP< 7 >( wf, jac, gamma, s, k ); break;
+        case 8:  EigP< 8 >( wf, jac, gamma, s, k ); break;
+        case 9:  EigP< 9 >( wf, jac, gamma, s, k ); break;
+        case 10: EigP< 10 >( wf, jac, gamma, s, k ); break;
+        default: EigGeneric( p, wf, jac, gamma, s, k ); break;
+    }
+}
+
+//
+// Local stiffness matrix of the Poisson equation.
+// No quadrature is needed, hence the generic loop is used for all degrees.
+//
+void EltKernel::Psn( size_t p, double jac, double* s )
+{
+    const size_t D = p + 1;
+
+    for( size_t i = 0; i < D; i++ )
+    {
+        for( size_t j = i; j < D; j++ )
+            s[ i * D + j ] = Lobatto::GetS( Psi( p, i ), Psi( p, j ) ) / jac;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef RATOM_ELTKERNEL_H
+#define RATOM_ELTKERNEL_H
+
+//
+// Element kernels: local matrices and local load vectors for one element.
+//
+// 1. The element of degree "p" has (p + 1) local basis functions.
+//    Local basis function "i" references the Lobatto polynomial \psi_{Psi(p, i)},
+//    see function Element::PsiId:
+//         i = 0     ->  \psi_0
+//         i = p     ->  \psi_1
+//         0 < i < p ->  \psi_{i+1}
+//
+// 2. Local matrices are stored row by row in arrays of size (p + 1) x (p + 1).
+//    Only the upper triangular part (j >= i) is defined.
+//
+// 3. Kernels of the eigenvalue problem for degrees 2, 3, ..., 10 are template functions with the degree as
+//    a template parameter. Hence, local matrices have fixed size and the loops over
+//    the basis functions are unrolled by the compiler. The kernel is selected once
+//    per element by switch on the runtime degree.
+//    For other degrees the generic kernel with runtime loop bounds is used.
+//
+// 4. Quadrature weights multiplied by the integrand evaluated at Gauss nodes are
+//    passed as argument "wf". The values of Lobatto polynomials at Gauss nodes are
+//    read from the table, see Gauss::Basis.
+//
+// Zbigniew Romanowski [ROMZ@wp.pl]
+//
+
+#include <cstddef>
+
+
+class EltKernel
+{
+public:
+    // Local stiffness "s" and overlap "k" matrices of the eigenvalue problem:
+    //    s_{i,j} = gamma S_{i,j} / jac + jac \int \psi_i \psi_j f
+    //    k_{i,j} = jac K_{i,j}
+    static void Eig( size_t p, const double* wf, double jac, double gamma, double* s, double* k );
+    static void EigGeneric( size_t p, const double* wf, double jac, double gamma, double* s, double* k );
+
+    // Local stiffness matrix of the Poisson equation:
+    //    s_{i,j} = S_{i,j} / jac
+    static void Psn( size_t p, double jac, double* s );
+
+    // Local load vector:
+    //    b_i = \int \psi_i f
+    static void Load( size_t p, const double* wf, double* b );
+
+    // Returns the index of the Lobatto polynomial for local basis function "i"
+    static constexpr size_t Psi( size_t p, size_t i )
+    {
+        return ( i == 0 ) ? 0 : ( ( i == p ) ? 1 : i + 1 );
+    }
+
+    // Degrees for which the specialized kernels are compiled
+    static const size_t MINP = 2;
+    static const size_t MAXP = 10;
+
+private:
+    // Matrices S and K in the local numbering of basis functions for element of degree P
+    template< size_t P >
+    struct LocalMtx
+    {
+        LocalMtx();
+        double m_s[ P + 1 ][ P + 1 ];
+        double m_k[ P + 1 ][ P + 1 ];
+    };
+
+    template< size_t P >
+    static void EigP( const double* wf, double jac, double gamma, double* s, double* k );
+};
+
+#endif
@@ -8,6 +8,8 @@
 *
 */
 
+#include <cstddef>
+
 
 class Fun1D
 {
@@ -16,6 +18,15 @@ public:
     virtual ~Fun1D(void) { }
 
     virtual double Get(double x) const = 0;
+
+    // Returns values val[i] = Get( x[i] ) for i = 0, 1, ..., n-1.
+    // Derived classes override it to share the work between the points,
+    // e.g. the search of the element containing the points.
+    virtual void Get(const double* x, size_t n, double* val) const
+    {
+        for(size_t i = 0; i < n; i++)
+            val[i] = Get(x[i]);
+    }
 };
 
 #endif
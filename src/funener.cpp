@@ -26,6 +26,27 @@ double EnerTotal::Get( double r ) const
     return ( ex + co - 0.5 * vh ) * rho;
 }
 
+//
+// Integrand for energy "Total" for radii r[0], ..., r[n-1]
+//
+void EnerTotal::Get( const double* r, size_t n, double* val ) const
+{
+    std::vector< double > vh( n );
+    m_pot.GetRho( r, n, val );
+    m_pot.Vh( r, n, &vh.front() );
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        const double rho = val[ i ];
+        const double rhoT = RhoTilde( r[ i ], rho );
+
+        const double ex = m_pot.m_exch->EdiffV( rhoT, 0 );
+        const double co = m_pot.m_corr->EdiffV( rhoT, 0 );
+
+        val[ i ] = ( ex + co - 0.5 * vh[ i ] ) * rho;
+    }
+}
+
 //
 // Integrand for energy "Nucleus"
 //
@@ -36,6 +57,17 @@ double EnerNucleus::Get( double r ) const
     return m_pot.Vn( r ) * rho;
 }
 
+//
+// Integrand for energy "Nucleus" for radii r[0], ..., r[n-1]
+//
+void EnerNucleus::Get( const double* r, size_t n, double* val ) const
+{
+    m_pot.GetRho( r, n, val );
+
+    for( size_t i = 0; i < n; i++ )
+        val[ i ] *= m_pot.Vn( r[ i ] );
+}
+
 //
 // Integrand for energy "Hartree"
 //
@@ -46,6 +78,19 @@ double EnerHartree::Get( double r ) const
     return 0.5 * m_pot.Vh( r ) * rho;
 }
 
+//
+// Integrand for energy "Hartree" for radii r[0], ..., r[n-1]
+//
+void EnerHartree::Get( const double* r, size_t n, double* val ) const
+{
+    std::vector< double > vh( n );
+    m_pot.GetRho( r, n, val );
+    m_pot.Vh( r, n, &vh.front() );
+
+    for( size_t i = 0; i < n; i++ )
+        val[ i ] = 0.5 * vh[ i ] * val[ i ];
+}
+
 //
 // Integrand for energy "Exchenge"
 //
@@ -57,6 +102,20 @@ double EnerExch::Get( double r ) const
     return m_pot.Ex( rhoT, 0 ) * rho;
 }
 
+//
+// Integrand for energy "Exchenge" for radii r[0], ..., r[n-1]
+//
+void EnerExch::Get( const double* r, size_t n, double* val ) const
+{
+    m_pot.GetRho( r, n, val );
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        const double rho = val[ i ];
+        val[ i ] = m_pot.Ex( RhoTilde( r[ i ], rho ), 0 ) * rho;
+    }
+}
+
 //
 // Integrand for energy "Correlation"
 //
@@ -68,6 +127,20 @@ double EnerCorr::Get( double r ) const
     return m_pot.Ec( rhoT, 0 ) * rho;
 }
 
+//
+// Integrand for energy "Correlation" for radii r[0], ..., r[n-1]
+//
+void EnerCorr::Get( const double* r, size_t n, double* val ) const
+{
+    m_pot.GetRho( r, n, val );
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        const double rho = val[ i ];
+        val[ i ] = m_pot.Ec( RhoTilde( r[ i ], rho ), 0 ) * rho;
+    }
+}
+
 //
 // Integrand for energy "Kinetic"
 //
@@ -84,5 +157,27 @@ double EnerKinetic::Get( double r ) const
     return ( vx + vc + vn + vh ) * rho;
 }
 
+//
+// Integrand for energy "Kinetic" for radii r[0], ..., r[n-1]
+//
+void EnerKinetic::Get( const double* r, size_t n, double* val ) const
+{
+    std::vector< double > vh( n );
+    m_pot.GetRho( r, n, val );
+    m_pot.Vh( r, n, &vh.front() );
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        const double rho = val[ i ];
+        const double rhoT = RhoTilde( r[ i ], rho );
+
+        const double vx = m_pot.Vx( rhoT, 0 );
+        const double vc = m_pot.Vc( rhoT, 0 );
+        const double vn = m_pot.Vn( r[ i ] );
+
+        val[ i ] = ( vx + vc + vn + vh[ i ] ) * rho;
+    }
+}
+
 
 
@@ -8,6 +8,7 @@
 //
 //
 
+#include <vector>
 #include "pot.h"
 
 
@@ -36,6 +37,7 @@ class EnerTotal : public FunEner
 public:
     EnerTotal( const Pot& pot ) : FunEner( pot ) { }
     virtual double Get( double r ) const;
+    virtual void Get( const double* r, size_t n, double* val ) const;
 };
 
 //
@@ -46,6 +48,7 @@ class EnerNucleus : public FunEner
 public:
     EnerNucleus( const Pot& pot ) : FunEner( pot ) { }
     virtual double Get( double r ) const;
+    virtual void Get( const double* r, size_t n, double* val ) const;
 };
 
 //
@@ -56,6 +59,7 @@ class EnerHartree : public FunEner
 public:
     EnerHartree( const Pot& pot ) : FunEner( pot ) { }
     virtual double Get( double r ) const;
+    virtual void Get( const double* r, size_t n, double* val ) const;
 };
 
 
@@ -67,6 +71,7 @@ class EnerExch : public FunEner
 public:
     EnerExch( const Pot& pot ) : FunEner( pot ) { }
     virtual double Get( double r ) const;
+    virtual void Get( const double* r, size_t n, double* val ) const;
 };
 
 
@@ -78,6 +83,7 @@ class EnerCorr : public FunEner
 public:
     EnerCorr( const Pot& pot ) : FunEner( pot ) { }
     virtual double Get( double r ) const;
+    virtual void Get( const double* r, size_t n, double* val ) const;
 };
 
 
@@ -89,6 +95,7 @@ class EnerKinetic : public FunEner
 public:
     EnerKinetic( const Pot& pot ) : FunEner( pot ) { }
     virtual double Get( double r ) const;
+    virtual void Get( const double* r, size_t n, double* val ) const;
 };
 
 #endif
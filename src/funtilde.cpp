@@ -9,8 +9,22 @@ FunTilde::FunTilde( const Element& elt, const Fun1D& f, double a, double b )
     , m_f( f )
     , m_fa( f.Get( a ) )
     , m_fb( f.Get( b ) )
+    , m_val( Gauss::Size() )
+    , m_wVal( Gauss::Size() )
 {
+    // Function \tilde{f} is evaluated once at each quadrature node,
+    // function f is evaluated for all quadrature nodes at once
+    for( size_t n = 0; n < m_val.size(); n++ )
+        m_wVal[ n ] = m_elt.X( Gauss::X( n ) );
 
+    m_f.Get( &m_wVal.front(), m_wVal.size(), &m_val.front() );
+
+    for( size_t n = 0; n < m_val.size(); n++ )
+    {
+        const double s = Gauss::X( n );
+        m_val[ n ] -= m_fa * Lobatto::Basis( 0, s ) + m_fb * Lobatto::Basis( 1, s );
+        m_wVal[ n ] = Gauss::W( n ) * m_val[ n ];
+    }
 }
 
 double FunTilde::Get( double s ) const
@@ -21,13 +35,13 @@ double FunTilde::Get( double s ) const
 
 double FunTilde::CalcB( size_t i ) const
 {
+    const double* bi = Gauss::Basis( i );
+    const size_t Q = m_wVal.size();
+
     double b = 0;
-    for( size_t n = 0; n < Gauss::Size(); n++ )
-    {
-        const double s = Gauss::X( n );
-        const double w = Gauss::W( n );
-        b += w * Lobatto::Basis( i, s ) * Get( s );
-    }
+    for( size_t n = 0; n < Q; n++ )
+        b += m_wVal[ n ] * bi[ n ];
+
     return b;
 }
 
@@ -37,14 +51,11 @@ double FunTilde::CalcB( size_t i ) const
 //
 double FunTilde::IntegF2( ) const
 {
-    double v, w, s, res = 0;
+    const size_t Q = m_wVal.size();
+
+    double res = 0;
+    for( size_t n = 0; n < Q; n++ )
+        res += m_wVal[ n ] * m_val[ n ];
 
-    for(size_t n = 0; n < Gauss::Size(); n++)
-    {
-        s = Gauss::X( n );
-        w = Gauss::W( n );
-        v = Get( s );
-        res += w * v * v;
-    }
     return m_elt.Jac() * res;
 }
@@ -1,6 +1,7 @@
 #ifndef RATOM_FUNTILDE_H
 #define RATOM_FUNTILDE_H
 
+#include <vector>
 #include "element.h"
 #include "fun1D.h"
 
@@ -13,6 +14,7 @@ public:
     double Get( double s ) const;
 
     double CalcB( size_t i ) const;
+    const double* WVal( ) const { return &m_wVal.front(); }
     double IntegF2( ) const;
 
 
@@ -22,6 +24,12 @@ private:
     const double m_fa;
     const double m_fb;
 
+    // Values of \tilde{f} at quadrature nodes
+    std::vector< double > m_val;
+
+    // Values of \tilde{f} at quadrature nodes multiplied by quadrature weights
+    std::vector< double > m_wVal;
+
 };
 
 #endif
@@ -1,23 +1,45 @@
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 #include "gauss.h"
 #include "gauleg.h"
 #include "lobatto.h"
 
-const size_t Gauss::m_deg = 3 * ( Lobatto::MAXP - 1 );
+size_t Gauss::m_deg = 0;
 std::vector< double > Gauss::m_w;
 std::vector< double > Gauss::m_x;
+std::vector< double > Gauss::m_basis;
+std::vector< double > Gauss::m_basisDer;
 
 //
 // Constructor
-// deg - degree of 1D Gaussiona quadrature
+// maxDeg - the maximal degree of elements. The number of quadrature nodes is 3 * maxDeg,
+//          but not less than 30 (the quadrature for elements of degree 10),
+//          since the integrands contain the potential, which is not a polynomial.
+// Object of class Lobatto must be created before.
 //
-Gauss::Gauss()
+Gauss::Gauss( size_t maxDeg )
 {
+    assert( maxDeg < Lobatto::MAXP );
+    m_deg = 3 * std::max( maxDeg, static_cast< size_t >( 10 ) );
+
     m_w.resize( m_deg );
     m_x.resize( m_deg );
 
     ::gauleg( -1, 1, m_x, m_w, m_deg );
+
+    // Lobatto polynomials are tabulated once, since quadrature nodes are fixed
+    m_basis.resize( Lobatto::MAXP * m_deg );
+    m_basisDer.resize( Lobatto::MAXP * m_deg );
+
+    for( size_t i = 0; i < Lobatto::MAXP; i++ )
+    {
+        for( size_t n = 0; n < m_deg; n++ )
+        {
+            m_basis[ i * m_deg + n ] = Lobatto::Basis( i, m_x[ n ] );
+            m_basisDer[ i * m_deg + n ] = Lobatto::BasisDer( i, m_x[ n ] );
+        }
+    }
 }
 
 
@@ -31,11 +53,18 @@ double Gauss::Calc( const Fun1D& f, double a, double b )
     const double q = 0.5 * ( a + b );
     const double p = 0.5 * ( b - a );
 
+    // The function is evaluated for all quadrature nodes at once
+    std::vector< double > x( m_deg ), v( m_deg );
+    for( size_t i = 0; i < m_deg; i++ )
+        x[ i ] = p * m_x[ i ] + q;
+
+    f.Get( &x.front(), m_deg, &v.front() );
+
     double sum = 0;
 
     for( size_t i = 0; i < m_deg; i++ )
     {
-        sum += m_w[ i ] * f.Get( p * m_x[ i ] + q );
+        sum += m_w[ i ] * v[ i ];
     }
 
     return p * sum;
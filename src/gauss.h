@@ -51,7 +51,7 @@
 class Gauss
 {
 public:
-    Gauss();
+    Gauss( size_t maxDeg );
     ~Gauss() = default;
 
     static double Calc( const Fun1D& f, double a, double b );
@@ -60,16 +60,28 @@ public:
     static double W( size_t i )  { return m_w[ i ]; }
     static double Size( )  { return m_x.size(); }
 
+    // Values of Lobatto polynomial $\psi_i$ and its derivative at all quadrature nodes
+    static const double* Basis( size_t i )    { return &m_basis[ i * m_deg ]; }
+    static const double* BasisDer( size_t i ) { return &m_basisDer[ i * m_deg ]; }
+
 
 private:
-    // Quadrature degree
-    static const size_t m_deg;
+    // Quadrature degree (number of nodes), it is defined by the constructor
+    static size_t m_deg;
 
     // Quadrature weights
     static std::vector< double > m_w;
 
     // Quadrature nodes
     static std::vector< double > m_x;
+
+    // Table of Lobatto polynomials at quadrature nodes.
+    // Element m_basis[ i * m_deg + n ] is equal to \psi_i( m_x[ n ] )
+    static std::vector< double > m_basis;
+
+    // Table of derivatives of Lobatto polynomials at quadrature nodes.
+    // Element m_basisDer[ i * m_deg + n ] is equal to \psi_i'( m_x[ n ] )
+    static std::vector< double > m_basisDer;
 };
 
 #endif
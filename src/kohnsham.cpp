@@ -1,7 +1,13 @@
 #include "kohnsham.h"
-#include "paramdb.h"
+#include "config.h"
 #include "stateset.h"
+#include "approxsolver.h"
 #include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cmath>
 
 //
 // Constructor
@@ -28,22 +34,30 @@ KohnSham::~KohnSham()
 //
 EigResult KohnSham::Solve( const Fun1D& pot )
 {
-    const bool adapt = ParamDb::GetBool( "Solver_EigAdapt" );
+    const bool adapt = Config::Get().m_eigAdapt;
+    const size_t threadNo = Config::Get().m_eigThreads;
 
-    EigResult eigResult;
-    for(size_t ell = 0; ell < m_eigProb.size(); ell++)
+    // The potential is new, hence its values must be calculated again
+    m_potCache.Reset( pot );
+
+    if( threadNo > 1 && m_eigProb.size() > 1 )
     {
-        const size_t eigNo = StateSet::GetNmax( ell );
-        if( adapt )
-        {
-            m_eigProb[ ell ].SolveAdapt( pot, eigNo );
-        }
-        else
+        SolveParallel( adapt, threadNo );
+    }
+    else
+    {
+        for( size_t ell = 0; ell < m_eigProb.size(); ell++ )
         {
-            m_eigProb[ ell ].Solve( pot, eigNo );
+            SolveEll( ell, adapt );
         }
+    }
 
-        // Sets eigenvalues of states
+    // Sets eigenvalues of states.
+    // Always in the order of increasing "ell", independently of the number of threads.
+    EigResult eigResult;
+    for( size_t ell = 0; ell < m_eigProb.size(); ell++ )
+    {
+        const size_t eigNo = StateSet::GetNmax( ell );
         for( size_t n = 0; n < eigNo; n++ )
         {
             const double eigVal = m_eigProb[ ell ].GetEigVal( n );
@@ -54,52 +68,199 @@ EigResult KohnSham::Solve( const Fun1D& pot )
     return eigResult;
 }
 
+//
+// Solves linear eigenvalue problem for angular quantum number "ell"
+//
+void KohnSham::SolveEll( size_t ell, bool adapt )
+{
+    const size_t eigNo = StateSet::GetNmax( ell );
+    if( adapt )
+    {
+        m_eigProb[ ell ].SolveAdapt( m_potCache, eigNo );
+    }
+    else
+    {
+        m_eigProb[ ell ].Solve( m_potCache, eigNo );
+    }
+}
+
+//
+// Solves the eigenvalue problems for all "ell" concurrently.
+// Each thread takes the next unsolved "ell" until all of them are solved.
+// The potential is only read (through the thread safe cache), and each EigProb owns its mesh and matrices.
+// The first exception thrown in a worker thread is rethrown in the calling thread.
+//
+void KohnSham::SolveParallel( bool adapt, size_t threadNo )
+{
+    threadNo = std::min( threadNo, m_eigProb.size() );
+
+    std::atomic< size_t > next( 0 );
+    std::vector< std::exception_ptr > error( m_eigProb.size() );
+
+    auto worker = [ & ]()
+    {
+        while( true )
+        {
+            const size_t ell = next++;
+            if( ell >= m_eigProb.size() )
+                break;
+
+            try
+            {
+                SolveEll( ell, adapt );
+            }
+            catch( ... )
+            {
+                error[ ell ] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector< std::thread > thread;
+    for( size_t t = 1; t < threadNo; t++ )
+    {
+        thread.push_back( std::thread( worker ) );
+    }
+
+    // The calling thread works as well
+    worker();
+
+    for( std::thread& t : thread )
+    {
+        t.join();
+    }
+
+    for( const std::exception_ptr& e : error )
+    {
+        if( e )
+            std::rethrow_exception( e );
+    }
+}
+
 //
 // Returns value of electron density for radius "r"
 //
 double KohnSham::Get( double r ) const
 {
-    const double rc	= ParamDb::GetDouble( "Atom_Rc" );
+    double rho;
+    Get( &r, 1, &rho );
+    return rho;
+}
+
+
+
+//
+// Returns values of electron density for radii r[0], ..., r[n-1].
+// For each angular momentum number the basis functions are evaluated once
+// for all states, see function EigProb::GetDensity.
+//
+void KohnSham::Get( const double* r, size_t n, double* val ) const
+{
+    const double rc	= Config::Get().m_rc;
     const size_t Lmax = StateSet::GetLmax();
 
-    if( r >= rc )
-        return 0;
+    // Points outside the atom are not passed to eigenfunctions
+    size_t inNo = 0;
+    while( inNo < n && r[ inNo ] < rc )
+        inNo++;
+
+    if( inNo < n )
+    {
+        for( size_t i = 0; i < n; i++ )
+            val[ i ] = ( r[ i ] < rc ) ? Get( r[ i ] ) : 0;
+        return;
+    }
 
-    double rho = 0;
+    std::vector< double > rhoL( n ), occ;
+    std::fill( val, val + n, 0. );
 
     // For all quantum angular menetum numbers
     for( size_t ell = 0; ell < Lmax; ell++ )
     {
-        double rhoL = 0;
-
         const size_t eigNo = StateSet::GetNmax( ell );
 
-        // For all states for fixed "ell"
-        for( size_t n = 0; n < eigNo; n++ )
-        {
-            const double occ = StateSet::Occ( ell, n );
-            if( occ > 0 )
-            {
-                const double rnl = m_eigProb[ ell ].GetEigFun( n, r ); // R_{n, \ell}(r)
-                rhoL += occ * rnl * rnl;
-            }
-        }
+        occ.resize( eigNo );
+        for( size_t k = 0; k < eigNo; k++ )
+            occ[ k ] = StateSet::Occ( ell, k );
+
+        m_eigProb[ ell ].GetDensity( &occ.front(), eigNo, r, n, &rhoL.front() );
 
         // Sum up all constituents
-        rho += rhoL;
+        for( size_t i = 0; i < n; i++ )
+            val[ i ] += rhoL[ i ];
     }
+}
 
-    return rho;
+
+//
+// Returns the nodes of meshes for all angular momentum numbers (sorted, without repetitions).
+// Each eigenfunction is a polynomial between two consecutive nodes.
+//
+std::vector< double > KohnSham::GetNode( ) const
+{
+    std::vector< double > node;
+
+    for( const EigProb& eigProb : m_eigProb )
+    {
+        const Mesh& mesh = eigProb.GetMesh();
+        for( size_t i = 0; i < mesh.XNo(); i++ )
+            node.push_back( mesh.X( i ) );
+    }
+
+    std::sort( node.begin(), node.end() );
+    node.erase( std::unique( node.begin(), node.end() ), node.end() );
+
+    return node;
 }
 
 
+//
+// Projects the electron density onto Lobatto polynomials on the intervals between
+// the nodes returned by GetNode. On each interval the density is a sum of products
+// of two eigenfunctions, i.e. a polynomial of degree at most 2p, where p is the largest
+// degree of elements. Hence, the projection of degree 2p evaluated by the Gauss quadrature
+// from the eigenvector coefficients is exact, and no interval is divided.
+// Returns "false" if 2p exceeds the tabulated Lobatto polynomials, see Config "m_maxDeg".
+//
+bool KohnSham::Project( Approx& rho ) const
+{
+    size_t pMax = 1;
+    for( const EigProb& eigProb : m_eigProb )
+        pMax = std::max( pMax, eigProb.GetMesh().GetBand() );
+
+    const size_t deg = 2 * pMax;
+    if( deg > Config::Get().m_maxDeg )
+        return false;
+
+    ApproxSolver approxSolver( deg, *this );
+    rho = approxSolver.Run( GetNode(), HUGE_VAL );
+    return true;
+}
+
+
+//
+// Writes the number of passes of adaptive algorithm (for all angular quantum numbers)
+// and the number of DOFs for each angular quantum number (one line)
+//
+void KohnSham::WriteDim( FILE* out ) const
+{
+    size_t passNo = 0;
+    for( const EigProb& e : m_eigProb )
+        passNo += e.PassNo();
+
+    fprintf( out, "*            Eig: passes = %lu, DOF per L =", static_cast< unsigned long >( passNo ) );
+    for( const EigProb& e : m_eigProb )
+        fprintf( out, " %lu", static_cast< unsigned long >( e.Dim() ) );
+    fprintf( out, "\n" );
+}
+
 
 //
 // Writes eigenfunctions into file.
 //
 void KohnSham::WriteEigen( ) const
 {
-    const size_t eigNode = ParamDb::GetSize_t( "Out_EigNode" );
+    const size_t eigNode = Config::Get().m_outEigNode;
     if( eigNode < 1 )
     {
         throw std::runtime_error( "Out_EigNode must be greater then zero." );
@@ -115,7 +276,7 @@ void KohnSham::WriteEigen( ) const
         for( size_t n = 0; n < eigNo; n++ )
         {
 
-            std::string path = ParamDb::GetString( "Out_EigPath" );
+            std::string path = Config::Get().m_outEigPath;
             path += ".";
             path += StateSet::Name( ell, n );
 
@@ -124,3 +285,39 @@ void KohnSham::WriteEigen( ) const
         }
     }
 }
+
+//
+// Writes information about memory used for eigenvectors.
+// Nothing is written for the dense engine, where the memory is the dense one.
+//
+void KohnSham::WriteMem( FILE* out ) const
+{
+    const double kB = 1024;
+    size_t mem = 0, memDense = 0;
+
+    if( Config::Get().m_eigEngine == EigEngine_Dense )
+        return;
+
+    fprintf(out, "\n\n");
+    fprintf(out, "===================================================================\n");
+    fprintf(out, "     E I G E N V E C T O R S   M E M O R Y\n");
+    fprintf(out, "-------------------------------------------------------------------\n");
+    fprintf(out, "%5s %10s %8s %18s %18s\n", "L", "DOF", "EigNo", "Used [kB]", "Dense [kB]");
+    fprintf(out, "-------------------------------------------------------------------\n");
+    for( size_t ell = 0; ell < m_eigProb.size(); ell++ )
+    {
+        const EigProb& e = m_eigProb[ ell ];
+        fprintf(out, "%5lu %10lu %8lu %18.1lf %18.1lf\n",
+            static_cast<unsigned long>( ell ),
+            static_cast<unsigned long>( e.Dim() ),
+            static_cast<unsigned long>( StateSet::GetNmax( ell ) ),
+            e.EigVecMem() / kB,
+            e.EigVecMemDense() / kB );
+
+        mem += e.EigVecMem();
+        memDense += e.EigVecMemDense();
+    }
+    fprintf(out, "-------------------------------------------------------------------\n");
+    fprintf(out, "   Total used = %.1lf kB,  saved = %.1lf kB\n", mem / kB, ( memDense > mem ? memDense - mem : 0 ) / kB );
+    fprintf(out, "===================================================================\n");
+}
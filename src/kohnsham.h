@@ -30,6 +30,15 @@
 //
 // 7. In the source code, for angular quantum number L, the "ell" name is used.
 //
+// 8. Equations (A) for different L are independent. If parameter Solver_EigThreads
+//    is greater than one, they are solved concurrently, each EigProb in its own thread.
+//    The eigenvalues are always collected in the order of increasing L,
+//    so the result does not depend on the number of threads.
+//
+// 9. Function KohnSham::Project returns the electron density as piecewise Lobatto expansion
+//    on the intervals between the nodes of all meshes. It is exact, since on each interval
+//    the density is a polynomial of twice the degree of elements.
+//
 //
 // Zbigniew Romanowski [ROMZ@wp.pl]
 //
@@ -38,7 +47,9 @@
 #include <cstddef>
 #include <vector>
 #include <cassert>
+#include <cstdio>
 #include "fun1D.h"
+#include "approx.h"
 #include "eigprob.h"
 #include "eigresult.h"
 
@@ -51,11 +62,19 @@ public:
 
     EigResult Solve( const Fun1D& pot );
     double Get( double r ) const;
+    void Get( const double* r, size_t n, double* val ) const;
+    std::vector< double > GetNode( ) const;
+    bool Project( Approx& rho ) const;
     void WriteEigen( ) const;
+    void WriteMem( FILE* out ) const;
+    void WriteDim( FILE* out ) const;
+    const PotCache& GetPotCache( ) const { return m_potCache; }
 
 
 private:
     void CalcOcc();
+    void SolveEll( size_t ell, bool adapt );
+    void SolveParallel( bool adapt, size_t threadNo );
 
 private:
     // One solver for each angular quantum number ell
@@ -63,6 +82,9 @@ private:
 
     // Number of calculated eigenvalues for each angular quantum number ell
     std::vector< size_t > m_eigNo;
+
+    // Values of the potential shared by all angular quantum numbers ell
+    PotCache m_potCache;
 };
 
 #endif
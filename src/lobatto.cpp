@@ -1,19 +1,45 @@
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 #include "lobatto.h"
 #include "gauss.h"
 
-const size_t Lobatto::MAXP = 11;
+size_t Lobatto::MAXP = 0;
 ClpMtx Lobatto::m_mtxS;
 ClpMtx Lobatto::m_mtxK;
+std::vector< double > Lobatto::m_recA;
+std::vector< double > Lobatto::m_recB;
+std::vector< double > Lobatto::m_recC;
 
 //
 // Constructor
+// maxDeg - the maximal degree of elements; Lobatto polynomials \psi_0, ..., \psi_{maxDeg} are tabulated.
 //
-Lobatto::Lobatto()
+Lobatto::Lobatto( size_t maxDeg )
 {
+    assert( maxDeg >= 1 );
+    MAXP = maxDeg + 1;
+
     CalcS();
     CalcK();
+    CalcRec();
+}
+
+//
+// Evaluates coefficients of the recurrence for Lobatto polynomials
+//
+void Lobatto::CalcRec()
+{
+    m_recA.assign( MAXP, 0. );
+    m_recB.assign( MAXP, 0. );
+    m_recC.assign( MAXP, 0. );
+
+    for( size_t k = 2; k < MAXP; k++ )
+    {
+        m_recA[ k ] = ( 2. * k - 1. ) / k;
+        m_recB[ k ] = ( k - 1. ) / k;
+        m_recC[ k ] = 1. / sqrt( 2. * ( 2. * k - 1. ) );
+    }
 }
 
 
@@ -35,59 +61,50 @@ void Lobatto::CalcS()
 
 //
 // Evaluates integral K_{i,j} = $\int_{-1}^1 \psi_i(x) \psi_j(x) dx$.
-// Integrals evaluated analiticaly.
+// Integrals evaluated analiticaly. Each Lobatto polynomial is the combination
+// of at most two Legendre polynomials:
+//     \psi_0 = ( L_0 - L_1 ) / 2,   \psi_1 = ( L_0 + L_1 ) / 2,
+//     \psi_k = ( L_k - L_{k-2} ) / \sqrt{ 2 (2k - 1) }   for k > 1
+// and Legendre polynomials are orthogonal: \int_{-1}^1 L_m L_n = 2 / (2n + 1) \delta_{m,n}.
 //
 void Lobatto::CalcK()
 {
-    m_mtxK.Assign( MAXP, MAXP, 0. );
-
-    m_mtxK.Set( 0, 0 ) = 2. / 3.;
-    m_mtxK.Set( 0, 1 ) = 1. / 3.;
-    m_mtxK.Set( 0, 2 ) = -1. / sqrt( 6. );
-    m_mtxK.Set( 0, 3 ) = 1. / ( 3. * sqrt( 10. ) );
-
-
-    m_mtxK.Set( 1, 1 ) = 2. / 3.;
-    m_mtxK.Set( 1, 2 ) = -1. / sqrt( 6. );
-    m_mtxK.Set( 1, 3 ) = -1. / ( 3. * sqrt( 10. ) );
-
-    m_mtxK.Set( 2, 2 ) = 2. / 5.;
-    m_mtxK.Set( 2, 4 ) = -1. / ( 5. * sqrt( 21. ) );
-
-    m_mtxK.Set( 3, 3 ) = 2. / 21.;
-    m_mtxK.Set( 3, 5 ) = -1. / ( 21. * sqrt( 5. ) );
-
-    m_mtxK.Set( 4, 4 ) =  2. / 45.;
-    m_mtxK.Set( 4, 6 ) = -1. / ( 9. * sqrt( 77. ) );
-
-    m_mtxK.Set( 5, 5 ) =  2. / 77.;
-    m_mtxK.Set( 5, 7 ) = -1. / ( 33. * sqrt( 13. ) );
-
-    m_mtxK.Set( 6, 6 ) =  2. / 117.;
-    m_mtxK.Set( 6, 8 ) = -1. / ( 13. * sqrt( 165. ) );
-
-    m_mtxK.Set( 7, 7 ) =  2. / 165.;
-    m_mtxK.Set( 7, 9 ) = -1. / ( 15. * sqrt( 221. ) );
-
-    m_mtxK.Set( 8, 8 ) =  2. / 221.;
-    m_mtxK.Set( 8, 10 ) = -1. / ( 17. * sqrt( 285. ) );
-
-    m_mtxK.Set( 9, 9 ) =  2. / 285.;
+    // Legendre expansion of \psi_k: coefficients "c" of L_{m} for m = "idx"
+    struct Expansion
+    {
+        size_t idx[ 2 ];
+        double c[ 2 ];
+    };
 
-    m_mtxK.Set( 10, 10 ) =  2. / 357.;
+    std::vector< Expansion > e( MAXP );
+    e[ 0 ] = { { 0, 1 }, { 0.5, -0.5 } };
+    if( MAXP > 1 )
+        e[ 1 ] = { { 0, 1 }, { 0.5, 0.5 } };
+    for( size_t k = 2; k < MAXP; k++ )
+    {
+        const double c = 1. / sqrt( 2. * ( 2. * k - 1. ) );
+        e[ k ] = { { k, k - 2 }, { c, -c } };
+    }
 
-    //
-    // Copying into the lower triangle part
-    for( size_t i = 0; i < m_mtxK.ColNo(); i++ )
+    m_mtxK.Assign( MAXP, MAXP, 0. );
+    for( size_t i = 0; i < MAXP; i++ )
     {
-        for( size_t j = 0; j < i; j++ )
+        for( size_t j = 0; j < MAXP; j++ )
         {
-            m_mtxK.Set( i, j ) = m_mtxK.Get( j, i );
+            double v = 0;
+            for( size_t a = 0; a < 2; a++ )
+            {
+                for( size_t b = 0; b < 2; b++ )
+                {
+                    if( e[ i ].idx[ a ] == e[ j ].idx[ b ] )
+                        v += e[ i ].c[ a ] * e[ j ].c[ b ] * 2. / ( 2. * e[ i ].idx[ a ] + 1. );
+                }
+            }
+            m_mtxK.Set( i, j ) = v;
         }
     }
 
     // assert( CheckMtxK() );
-
 }
 
 /*
@@ -132,173 +149,163 @@ bool Lobatto::CheckMtxK( )
 */
 
 //
-// Returns the value of basis function $\psi_i(s)$
-// First eleven (for i = 0, 1, ..., 10) Lobatto hierarchic shape functions.
+// Returns the value of basis function $\psi_i(s)$.
+// Legendre polynomials are evaluated by the three-term recurrence, see item 9 in the header file.
 //
 double Lobatto::Basis( size_t i, double s )
 {
-    using Polynomial = double (*) (double);
+    assert( i < MAXP );
+    assert( s >= -1 && s <= 1 );
+
+    if( i == 0 )
+        return 0.5 * ( 1 - s );
 
-    static const std::vector< Polynomial > poly =
+    if( i == 1 )
+        return 0.5 * ( 1 + s );
+
+    // L_{k-2}(s) and L_{k-1}(s)
+    double l0 = 1;
+    double l1 = s;
+    for( size_t k = 2; k < i; k++ )
     {
-        Poly0,
-        Poly1,
-        Poly2,
-        Poly3,
-        Poly4,
-        Poly5,
-        Poly6,
-        Poly7,
-        Poly8,
-        Poly9,
-        Poly10
-    };
+        const double l2 = m_recA[ k ] * s * l1 - m_recB[ k ] * l0;
+        l0 = l1;
+        l1 = l2;
+    }
 
-    assert( i < poly.size() );
-    const double v = poly[ i ]( s );
-    return v;
+    const double l2 = m_recA[ i ] * s * l1 - m_recB[ i ] * l0;
+    return m_recC[ i ] * ( l2 - l0 );
 }
 
 //
+// Evaluates all basis functions \psi_0(s), ..., \psi_p(s) at point "s".
+// Array "v" must have at least (p + 1) elements.
 //
-//
-double Lobatto::Poly0( double s )
+void Lobatto::BasisAll( size_t p, double s, double* v )
 {
+    assert( p >= 1 && p < MAXP );
     assert( s >= -1 && s <= 1 );
-    constexpr double c = 0.5;
-    const double v = 1 - s;
-    return c * v;
-}
 
-//
-//
-//
-double Lobatto::Poly1( double s )
-{
-    assert( s >= -1 && s <= 1 );
-    constexpr double c = 0.5;
-    const double v = 1 + s;
-    return c * v;
-}
+    v[ 0 ] = 0.5 * ( 1 - s );
+    v[ 1 ] = 0.5 * ( 1 + s );
 
-//
-//
-//
-double Lobatto::Poly2( double s )
-{
-    assert( s >= -1 && s <= 1 );
-    constexpr double c = sqrt( 3. / 2.) / 2.;
-    const double s2 = s * s;
-    const double v = s2 - 1;
-    return c * v;
+    double l0 = 1;
+    double l1 = s;
+    for( size_t k = 2; k <= p; k++ )
+    {
+        const double l2 = m_recA[ k ] * s * l1 - m_recB[ k ] * l0;
+        v[ k ] = m_recC[ k ] * ( l2 - l0 );
+        l0 = l1;
+        l1 = l2;
+    }
 }
 
 //
+// Evaluates all basis functions \psi_0, ..., \psi_p at "n" points s[0], ..., s[n-1].
+// On return v[ k * n + j ] = \psi_k( s[ j ] ), so array "v" must have at least (p + 1) * n elements.
 //
+// The points are processed in blocks of at most "blockSize" points, the block has the size
+// of the actual run (no padding). For each degree "k" the loop over the points of the block
+// writes directly into "v" and has no dependence between iterations, hence it is vectorized.
+// The function pays off when the basis is shared by several expansions, see EigProb::GetDensity.
+// For a single expansion use function Expand.
 //
-double Lobatto::Poly3( double s )
+void Lobatto::BasisAll( size_t p, const double* s, size_t n, double* v )
 {
-    assert( s >= -1 && s <= 1 );
-    constexpr double c = sqrt( 5. / 2.) / 2.;
-    const double s2 = s * s;
-    const double v = ( s2 - 1 ) * s;
-    return c * v;
-}
+    assert( p >= 1 && p < MAXP );
 
-//
-//
-//
-double Lobatto::Poly4( double s )
-{
-    assert( s >= -1 && s <= 1 );
-    constexpr double c = sqrt( 7. / 2.) / 8.;
-    const double s2 = s * s;
-    const double v = ( s2 - 1 ) * ( 5 * s2 - 1 );
-    return c * v;
-}
+    const size_t blockSize = 64;
 
-//
-//
-//
-double Lobatto::Poly5( double s )
-{
-    assert( s >= -1 && s <= 1 );
-    constexpr double c = sqrt( 9. / 2.) / 8.;
-    const double s2 = s * s;
-    const double v = ( s2 - 1 ) * ( 7 * s2 - 3 ) * s;
-    return c * v;
-}
+    // Legendre polynomials L_{k-2}, L_{k-1} at the points of the block
+    double l0[ blockSize ], l1[ blockSize ];
 
-//
-//
-//
-double Lobatto::Poly6( double s )
-{
-    assert( s >= -1 && s <= 1 );
-    constexpr double c = sqrt( 11. / 2. ) / 16.;
-    const double s2 = s * s;
-    // const double s4 = s2 * s2;
-    // const double v = ( s2 - 1 ) * ( 21 * s4 - 14 * s2 + 1 );
-    const double v = ( s2 - 1 ) * ( 21 * s2 * s2 - 14 * s2 + 1 );
-    return c * v;
-}
+    for( size_t j0 = 0; j0 < n; j0 += blockSize )
+    {
+        const size_t m = std::min( blockSize, n - j0 );
+        const double* sb = s + j0;
 
-//
-//
-//
-double Lobatto::Poly7( double s )
-{
-    assert( s >= -1 && s <= 1 );
-    constexpr double c = sqrt( 13. / 2. ) / 16.;
-    const double s2 = s * s;
-    //const double s4 = s2 * s2;
-    //const double v = ( s2 - 1 ) * ( 33 * s4 - 30 * s2 + 5 ) * s;
-    const double v = ( s2 - 1 ) * ( 33 * s2 * s2 - 30 * s2 + 5 ) * s;
-    return c * v;
-}
+        double* v0 = v + j0;
+        double* v1 = v + n + j0;
+        for( size_t j = 0; j < m; j++ )
+        {
+            v0[ j ] = 0.5 * ( 1 - sb[ j ] );
+            v1[ j ] = 0.5 * ( 1 + sb[ j ] );
+            l0[ j ] = 1;
+            l1[ j ] = sb[ j ];
+        }
 
-//
-//
-//
-double Lobatto::Poly8( double s )
-{
-    assert( s >= -1 && s <= 1 );
-    constexpr double c = sqrt( 15. / 2. ) / 128.;
-    const double s2 = s * s;
-    //const double s4 = s2 * s2;
-    //const double s6 = s4 * s2;
-    //const double v = ( s2 - 1 ) * ( 429 * s6 - 495 * s4 + 135 * s2 - 5 );
-    const double v = ( s2 - 1 ) * ( 429 * s2 * s2 * s2 - 495 * s2 * s2 + 135 * s2 - 5 );
-    return c * v;
+        for( size_t k = 2; k <= p; k++ )
+        {
+            const double a = m_recA[ k ];
+            const double b = m_recB[ k ];
+            const double c = m_recC[ k ];
+
+            double* vk = v + k * n + j0;
+            for( size_t j = 0; j < m; j++ )
+            {
+                const double l2 = a * sb[ j ] * l1[ j ] - b * l0[ j ];
+                vk[ j ] = c * ( l2 - l0[ j ] );
+                l0[ j ] = l1[ j ];
+                l1[ j ] = l2;
+            }
+        }
+    }
 }
 
 //
+// Estimates the decay rate \sigma of coefficients of bubble functions, see item 10 in the header file.
+// bubble - absolute values of coefficients of \psi_2, ..., \psi_{n+1}
+// The line is fitted to log|c_k| for at most four last coefficients, "exp" of its slope is returned.
+// If there are less than two coefficients the value 1 is returned (decay is unknown).
 //
-//
-double Lobatto::Poly9( double s )
+double Lobatto::Decay( const double* bubble, size_t n )
 {
-    assert( s >= -1 && s <= 1 );
-    constexpr double c = sqrt( 17. / 2. ) / 128.;
-    const double s2 = s * s;
-    //const double s4 = s2 * s2;
-    //const double s6 = s4 * s2;
-    //const double v = ( s2 - 1 ) * ( 715 * s6 - 1001 * s4 + 385 * s2 - 35 ) * s;
-    const double v = ( s2 - 1 ) * ( 715 * s2 * s2 * s2 - 1001 * s2 * s2 + 385 * s2 - 35 ) * s;
-    return c * v;
+    const size_t m = std::min( n, static_cast< size_t >( 4 ) );
+    if( m < 2 )
+        return 1;
+
+    // To avoid log(0)
+    const double tiny = 1E-300;
+
+    double sk = 0, sy = 0, skk = 0, sky = 0;
+    for( size_t i = n - m; i < n; i++ )
+    {
+        const double k = static_cast< double >( i );
+        const double y = std::log( std::max( bubble[ i ], tiny ) );
+        sk += k;
+        sy += y;
+        skk += k * k;
+        sky += k * y;
+    }
+
+    const double slope = ( m * sky - sk * sy ) / ( m * skk - sk * sk );
+    return std::exp( slope );
 }
 
 //
+// Returns the value of derivative of basis function $\psi_i'(s)$.
+// Legendre polynomial L_{i-1} is evaluated by the three-term recurrence.
 //
-//
-double Lobatto::Poly10( double s )
+double Lobatto::BasisDer( size_t i, double s )
 {
+    assert( i < MAXP );
     assert( s >= -1 && s <= 1 );
-    constexpr double c = sqrt( 19. / 2. ) / 256;
-    const double s2 = s * s;
-    const double s4 = s2 * s2;
-    const double s6 = s4 * s2;
-    const double s8 = s6 * s2;
-    const double v = ( s2 - 1 ) * ( 2431 * s8 - 4004 * s6 + 2002 * s4 - 308 * s2 + 7 );
-    return c * v;
-}
 
+    if( i == 0 )
+        return -0.5;
+
+    if( i == 1 )
+        return 0.5;
+
+    // L_0(s) = 1, L_1(s) = s
+    double p0 = 1;
+    double p1 = s;
+    for( size_t k = 1; k + 1 < i; k++ )
+    {
+        const double p2 = ( ( 2 * k + 1 ) * s * p1 - k * p0 ) / ( k + 1 );
+        p0 = p1;
+        p1 = p2;
+    }
+
+    return sqrt( ( 2. * i - 1. ) / 2. ) * p1;
+}
@@ -22,7 +22,11 @@
 //         \psi_8(s) = \frac{1/128} \sqrt{ \frac{15/2} } (s^2 − 1) (429 s^6 − 495 s^4 + 135 s^2 − 5)
 //         \psi_9(s) = \frac{1/128} \sqrt{ \frac{17/2} } (s^2 − 1) (715 s^6 − 1001 s^4 + 385 s^2 − 35) s
 //         \psi_{10}(s) = \frac{1/256} \sqrt{ \frac{7/2} } (s^2 − 1) (2431 s^8 − 4004 s^6 + 2002 s^4 − 308 s^2 + 7)
-//  These values are evaluated by function Lobatto::Basis
+//  The explicit formulas are given for reference only. Lobatto polynomials of any degree
+//  are evaluated by the recurrence, see item 9 and function Lobatto::Basis.
+//  The polynomials, and matrices K and S, are generated at startup for degrees
+//  0, 1, ..., maxDeg, where maxDeg is the largest element degree used by the solvers
+//  (the argument of constructor).
 //
 // 4. Moreover, we have:
 //                 | 1   for k = 0
@@ -43,7 +47,31 @@
 //    Elements of matrix K are returned by function Lobatto::GetS
 //    and they are evaluated by function Lobatto::CalcS
 //
-// 7. Values of matrix K and S are listed in my paper
+// 7. Derivatives of Lobatto polynomials are given by Legendre polynomials L_k(s):
+//         \psi_0'(s) = -1/2
+//         \psi_1'(s) = 1/2
+//         \psi_k'(s) = \sqrt{ \frac{(2k - 1)/2} } L_{k-1}(s)   for k > 1
+//    These values are evaluated by function Lobatto::BasisDer
+//
+// 8. Values of Lobatto polynomials and their derivatives at Gauss quadrature nodes
+//    are tabulated by class Gauss, see Gauss::Basis and Gauss::BasisDer
+//
+// 9. Lobatto polynomials of all degrees 0, 1, ..., p at once are evaluated by the recurrence
+//         \psi_k(s) = ( L_k(s) - L_{k-2}(s) ) / \sqrt{ 2 (2k - 1) }   for k > 1
+//    where Legendre polynomials satisfy
+//         L_k(s) = ( (2k - 1) s L_{k-1}(s) - (k - 1) L_{k-2}(s) ) / k
+//    see functions Lobatto::BasisAll and Lobatto::Expand.
+//    The version of BasisAll for many points has the loop over points as the inner loop,
+//    hence it is vectorized by the compiler. It is used when several expansions share
+//    the basis (e.g. density of many eigenfunctions). A single expansion is evaluated
+//    point by point by Expand, which needs no temporary storage and is faster.
+//
+// 10. For a function analytic in the neighbourhood of element, the coefficients of expansion
+//    in Lobatto polynomials decay exponentially: |c_k| ~ C \sigma^k, with \sigma < 1.
+//    The decay rate \sigma is estimated by function Lobatto::Decay (least squares fit of log|c_k|).
+//    It is used by hp-adaptive solvers to choose between division of element and increasing its degree.
+//
+// 11. Values of matrix K and S are listed in my paper
 //    Z. Romanowski "Application of h-adaptive, high order finite element method to
 //    solve radial Schrodinger equation", Molecular Physics, vol. 107, pp. 1339-1348 (2009).
 //
@@ -60,10 +88,19 @@
 class Lobatto
 {
 public:
-    Lobatto();
+    Lobatto( size_t maxDeg );
     ~Lobatto() = default;
 
     static double Basis( size_t i, double s );
+    static double BasisDer( size_t i, double s );
+
+    static void BasisAll( size_t p, double s, double* v );
+    static void BasisAll( size_t p, const double* s, size_t n, double* v );
+
+    template< typename Coef >
+    static double Expand( size_t p, double s, const Coef& coef );
+
+    static double Decay( const double* bubble, size_t n );
 
     static double GetK( size_t i, size_t j );
     static double GetS( size_t i, size_t j );
@@ -71,24 +108,14 @@ public:
 private:
     static void CalcS();
     static void CalcK();
+    static void CalcRec();
     // static bool CheckMtxK( );
     // static double CalcNumericK( size_t i, size_t j );
 
-    static double Poly0( double s );
-    static double Poly1( double s );
-    static double Poly2( double s );
-    static double Poly3( double s );
-    static double Poly4( double s );
-    static double Poly5( double s );
-    static double Poly6( double s );
-    static double Poly7( double s );
-    static double Poly8( double s );
-    static double Poly9( double s );
-    static double Poly10( double s );
-
 public:
-    // Maximal element degree
-    static const size_t MAXP;
+    // Number of tabulated Lobatto polynomials (the maximal element degree plus one),
+    // it is defined by the constructor
+    static size_t MAXP;
 
 private:
     // Matrix S
@@ -99,6 +126,15 @@ private:
     // K_{i,j} = \int_{-1}^{1} \psi_i(s) \psi_j(s) ds
     static ClpMtx m_mtxK;
 
+    // Coefficients of the recurrence for Legendre polynomials:
+    // L_k(s) = m_recA[ k ] s L_{k-1}(s) - m_recB[ k ] L_{k-2}(s)
+    static std::vector< double > m_recA;
+    static std::vector< double > m_recB;
+
+    // Normalization of Lobatto polynomials:
+    // \psi_k(s) = m_recC[ k ] ( L_k(s) - L_{k-2}(s) )
+    static std::vector< double > m_recC;
+
 };
 
 
@@ -126,6 +162,34 @@ double Lobatto::GetS( size_t i, size_t j )
     return m_mtxS.Get( i, j );
 }
 
+//
+// Returns the expansion
+//     \sum_{k=0}^p coef( k ) \psi_k(s)
+// Lobatto polynomials are evaluated by the recurrence, no temporary storage is needed.
+//
+template< typename Coef >
+inline
+double Lobatto::Expand( size_t p, double s, const Coef& coef )
+{
+    assert( p >= 1 && p < MAXP );
+    assert( s >= -1 && s <= 1 );
+
+    double val = coef( 0 ) * 0.5 * ( 1 - s ) + coef( 1 ) * 0.5 * ( 1 + s );
+
+    // L_{k-2}(s) and L_{k-1}(s)
+    double l0 = 1;
+    double l1 = s;
+    for( size_t k = 2; k <= p; k++ )
+    {
+        const double l2 = m_recA[ k ] * s * l1 - m_recB[ k ] * l0;
+        val += coef( k ) * m_recC[ k ] * ( l2 - l0 );
+        l0 = l1;
+        l1 = l2;
+    }
+
+    return val;
+}
+
 
 #endif
 
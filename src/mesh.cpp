@@ -2,6 +2,7 @@
 #include "mesh.h"
 #include <cassert>
 #include <algorithm>
+#include <cmath>
 
 //
 // Constructor
@@ -25,6 +26,15 @@ Mesh::~Mesh(void)
 // "degree.size() == x.size() - 1"
 //
 void Mesh::Set(const std::vector<double>& x, const std::vector<size_t>& degree)
+{
+    m_root = x;
+    Define(x, degree);
+}
+
+//
+// Defines the mesh (the initial mesh is not changed).
+//
+void Mesh::Define(const std::vector<double>& x, const std::vector<size_t>& degree)
 {
     assert(degree.size() == x.size() - 1);
     assert(x.size() >= 2);
@@ -96,6 +106,80 @@ double r;
 
 }
 
+//
+// Generates the mesh on the interval [a, b] with $nodeNo$ nodes of distribution "type".
+// Each element has $degree$. For graded meshes "r0" is the length of the first element.
+//
+void Mesh::Gen(MeshType type, double a, double b, size_t nodeNo, size_t degree, double r0)
+{
+std::vector<double> x;
+
+    if(type == MeshType_Lin)
+    {
+        GenLin(a, b, nodeNo, degree);
+        return;
+    }
+
+    GenNode(type, a, b, nodeNo, r0, x);
+
+    std::vector<size_t> deg(x.size() - 1, degree);
+    Set(x, deg);
+}
+
+//
+// Generates $nodeNo$ nodes of distribution "type" on the interval [a, b], see enum MeshType.
+// If the graded distribution can not be defined (r0 is too large), the nodes are uniform.
+//
+void Mesh::GenNode(MeshType type, double a, double b, size_t nodeNo, double r0, std::vector<double>& x)
+{
+const double len = b - a;
+const size_t M = nodeNo - 1; // Number of elements
+size_t i;
+
+    assert(b > a);
+    assert(nodeNo >= 2);
+
+    x.assign(nodeNo, a);
+
+    if(type == MeshType_Exp && r0 * M < len)
+    {
+        // The ratio "q" of lengths of neighbour elements: r0 (q^M - 1) / (q - 1) = len
+        double lo = 1, hi = 2;
+        while(r0 * (std::pow(hi, (double)M) - 1) / (hi - 1) < len)
+            hi *= 2;
+
+        for(int iter = 0; iter < 200; iter++)
+        {
+            const double q = 0.5 * (lo + hi);
+            if(r0 * (std::pow(q, (double)M) - 1) / (q - 1) < len)
+                lo = q;
+            else
+                hi = q;
+        }
+
+        const double q = 0.5 * (lo + hi);
+        double h = r0;
+        for(i = 1; i < nodeNo; i++)
+        {
+            x[i] = x[i - 1] + h;
+            h *= q;
+        }
+    }
+    else if((type == MeshType_Log || type == MeshType_Atom) && M >= 2 && r0 < len)
+    {
+        for(i = 1; i < nodeNo; i++)
+            x[i] = a + r0 * std::pow(len / r0, (double)(i - 1) / (double)(M - 1));
+    }
+    else
+    {
+        for(i = 1; i < nodeNo; i++)
+            x[i] = a + i * len / M;
+    }
+
+    // To avoid the rounding errors
+    x.back() = b;
+}
+
 /*
 //!
 //! Create connectivity array
@@ -232,9 +316,56 @@ bool Mesh::IsInRange(double x) const
 
 //
 // Searching the interval containg the value $x$: $x_{m} <= x <= x_{m+1}$
-// returns index $m$
+// returns index $m$. If $x$ is a vertex, the element on the left side is returned.
+// If $x$ is out of the mesh, the value "XNo() - 1" is returned.
+//
+// Binary search is used, the cost is O(log N). The function has no state,
+// hence it can be called concurrently.
 //
 size_t Mesh::FindElt(double x) const
+{
+    // It also rejects NaN
+    if(!(x >= m_x.front() && x <= m_x.back()))
+        return m_x.size() - 1;
+
+    if(x == m_x.front())
+        return 0;
+
+    // The first vertex (apart from the left end) not smaller than $x$
+    return std::lower_bound(m_x.begin() + 1, m_x.end(), x) - (m_x.begin() + 1);
+}
+
+//
+// As above, but the element "hint" and its right neighbour are checked first.
+// On return "hint" holds the element found. The caller owns "hint", so for
+// monotone sequence of queries the cost is O(1), and no state of the mesh is changed.
+// The initial value of "hint" may be any number, e.g. zero.
+//
+size_t Mesh::FindElt(double x, size_t& hint) const
+{
+const size_t N = m_elt.size();
+
+    if(x > m_x.front())
+    {
+        for(size_t n = hint; n < N && n <= hint + 1; n++)
+        {
+            if(m_x[n] < x && x <= m_x[n + 1])
+                return (hint = n);
+        }
+    }
+
+    const size_t n = FindElt(x);
+    if(n < N)
+        hint = n;
+
+    return n;
+}
+
+//
+// Searching the interval containg the value $x$ by visiting all elements.
+// The result is the same as for function "FindElt".
+//
+size_t Mesh::FindEltLinear(double x) const
 {
 size_t n;
     for(n = 0; n < m_x.size() - 1; n++)
@@ -246,21 +377,172 @@ size_t n;
 }
 
 //
-// Adds element to the mesh
+// Returns "true" if both meshes have the same nodes and the same element degrees
+//
+bool Mesh::IsSame(const Mesh& mesh) const
+{
+    if(m_x != mesh.m_x)
+        return false;
+
+    for(size_t n = 0; n < m_elt.size(); n++)
+    {
+        if(m_elt[n].P() != mesh.m_elt[n].P())
+            return false;
+    }
+    return true;
+}
+
+//
+// Adds element to the mesh: each element from "eltToSplit" is divided into two halves.
+// Both halves have the degree of the divided element.
 //
 void Mesh::AddToMesh(const std::vector<size_t>& eltToSplit)
 {
-size_t i, n;
-std::vector<double> newX(m_x);
-std::vector<size_t> newDegree(m_x.size() - 1 + eltToSplit.size(), m_elt[0].P()); // All elements has the same degree
+std::vector<bool> split(m_elt.size(), false);
+std::vector<double> newX(1, m_x.front());
+std::vector<size_t> newDegree;
+size_t n;
+
+    for(n = 0; n < eltToSplit.size(); n++)
+        split[eltToSplit[n]] = true;
 
-    for(i = 0; i < eltToSplit.size(); i++)
+    for(n = 0; n < m_elt.size(); n++)
     {
-        n = eltToSplit[i];
-        double tmp = (X(n) + X(n + 1)) / 2;
-        newX.push_back(tmp);
+        if(split[n])
+        {
+            newX.push_back((X(n) + X(n + 1)) / 2);
+            newDegree.push_back(m_elt[n].P());
+        }
+        newX.push_back(m_x[n + 1]);
+        newDegree.push_back(m_elt[n].P());
     }
-    std::sort(newX.begin(), newX.end());
 
-    Set(newX, newDegree);
+    Define(newX, newDegree);
+}
+
+//
+// Increases by one the degree of each element from "eltToRaise".
+// The vertices are not changed.
+//
+void Mesh::Raise(const std::vector<size_t>& eltToRaise)
+{
+std::vector<size_t> newDegree(m_elt.size());
+size_t n;
+
+    for(n = 0; n < m_elt.size(); n++)
+        newDegree[n] = m_elt[n].P();
+
+    for(n = 0; n < eltToRaise.size(); n++)
+        newDegree[eltToRaise[n]]++;
+
+    Define(m_x, newDegree);
+}
+
+//
+// Joins the pairs of sibling elements (see function IsSibling), if the indicators of both
+// elements "ind" are much less than the required accuracy "tol" of the adaptive algorithm.
+// The indicator behaves as h^{p+1} (h - length of element, p - degree), hence the joined
+// element is not divided again, if the solution did not change much.
+// Returns the number of joined pairs. The connectivity must be created again, if it is not zero.
+//
+size_t Mesh::Coarsen(const std::vector<double>& ind, double tol)
+{
+const size_t N = m_elt.size();
+const double limit = tol / std::pow(2.0, static_cast<double>(GetBand() + 2));
+std::vector<size_t> eltToJoin;
+
+    assert(ind.size() == N);
+
+    size_t n = 0;
+    while(n + 1 < N)
+    {
+        if(ind[n] < limit && ind[n + 1] < limit && IsSibling(n))
+        {
+            eltToJoin.push_back(n);
+            n += 2;
+        }
+        else
+            n++;
+    }
+
+    if(!eltToJoin.empty())
+        Join(eltToJoin);
+
+    return eltToJoin.size();
+}
+
+//
+// Joins elements "n" and "n+1" for each "n" from "eltToJoin".
+// Both elements must be obtained by division of one element, see function IsSibling.
+// The joined element has the larger degree of both elements.
+//
+void Mesh::Join(const std::vector<size_t>& eltToJoin)
+{
+std::vector<bool> join(m_elt.size(), false);
+std::vector<double> newX(1, m_x.front());
+std::vector<size_t> newDegree;
+size_t n;
+
+    for(n = 0; n < eltToJoin.size(); n++)
+    {
+        assert(IsSibling(eltToJoin[n]));
+        join[eltToJoin[n]] = true;
+    }
+
+    n = 0;
+    while(n < m_elt.size())
+    {
+        if(join[n])
+        {
+            newDegree.push_back(std::max(m_elt[n].P(), m_elt[n + 1].P()));
+            newX.push_back(m_x[n + 2]);
+            n += 2;
+        }
+        else
+        {
+            newDegree.push_back(m_elt[n].P());
+            newX.push_back(m_x[n + 1]);
+            n++;
+        }
+    }
+
+    Define(newX, newDegree);
+}
+
+//
+// Returns "true" if elements "n" and "n+1" were obtained by division of one element,
+// i.e. they are two halves of element of the initial mesh, or of element
+// obtained from it by divisions.
+//
+bool Mesh::IsSibling(size_t n) const
+{
+const double eps = 1E-6;
+
+    if(n + 1 >= m_elt.size())
+        return false;
+
+    const double a = m_x[n];
+    const double b = m_x[n + 1];
+    const double c = m_x[n + 2];
+    const double h = b - a;
+
+    // Both elements must have the same length
+    if(fabs((c - b) - h) > eps * h)
+        return false;
+
+    // Element of the initial mesh containing both elements
+    const size_t k = std::upper_bound(m_root.begin(), m_root.end(), a + eps * h) - m_root.begin() - 1;
+    if(k + 1 >= m_root.size() || c > m_root[k + 1] + eps * h)
+        return false;
+
+    // The elements are not divided
+    const double H = m_root[k + 1] - m_root[k];
+    if(h > 0.5 * H * (1 + eps))
+        return false;
+
+    // The left element must be on even position among the elements with length "h"
+    const double t = (a - m_root[k]) / h;
+    const double j = std::floor(t + 0.5);
+
+    return (fabs(t - j) < eps) && (std::fmod(j, 2.0) == 0);
 }
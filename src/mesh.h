@@ -12,6 +12,17 @@
 #include "element.h"
 #include "bndr.h"
 
+//
+// Distribution of nodes of the initial mesh on the interval [a, b], see function Mesh::Gen
+//
+enum MeshType
+{
+    MeshType_Lin = 0, // Uniform nodes
+    MeshType_Exp,     // The lengths of elements grow geometrically, the first element has length r0
+    MeshType_Log,     // The first element is [a, a + r0], then nodes are uniform in log(x - a)
+    MeshType_Atom     // As MeshType_Log, with r0 = 1/Z (Z - atomic number)
+};
+
 class Mesh
 {
 public:
@@ -20,7 +31,12 @@ public:
 
     void GenLin(double a, double b, size_t nodeNo, size_t degree);
     void GenLinExp(double a, double b, int m, size_t degree);
+    void Gen(MeshType type, double a, double b, size_t nodeNo, size_t degree, double r0);
+    static void GenNode(MeshType type, double a, double b, size_t nodeNo, double r0, std::vector<double>& x);
     void AddToMesh(const std::vector<size_t>& eltToSplit);
+    void Join(const std::vector<size_t>& eltToJoin);
+    size_t Coarsen(const std::vector<double>& ind, double tol);
+    void Raise(const std::vector<size_t>& eltToRaise);
 
     void Set(const std::vector<double>& x, const std::vector<size_t>& degree);
 
@@ -41,14 +57,26 @@ public:
 
     bool IsInRange(double x) const;
     size_t FindElt(double x) const;
+    size_t FindElt(double x, size_t& hint) const;
+    size_t FindEltLinear(double x) const;
+
+    bool IsSame(const Mesh& mesh) const;
+    bool IsSibling(size_t n) const;
 
 
+private:
+    void Define(const std::vector<double>& x, const std::vector<size_t>& degree);
+
 private:
     // Array of elements
     std::vector<Element> m_elt;
 
     // vertex coordinates (rozmiar o jeden wiekszy od m_elt.size())
     std::vector<double> m_x;
+
+    // Vertex coordinates of the initial mesh (defined by function Set).
+    // Functions AddToMesh and Join do not change them.
+    std::vector<double> m_root;
 };
 
 #endif
@@ -0,0 +1,95 @@
+//
+// Micro-benchmark for the element lookup, see function Mesh::FindElt.
+//
+// For meshes with growing number of elements the time per query is measured
+// for a monotone sequence of points (as during assembly and output, the caller
+// keeps the hint) and for a random sequence of points (binary search). The linear search is measured for comparison
+// on the smaller meshes only.
+//
+// Usage: meshbench.x
+//
+// Zbigniew Romanowski [ROMZ@wp.pl]
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "mesh.h"
+
+
+//
+// Returns the elapsed time in seconds
+//
+static double Elapsed( const std::chrono::steady_clock::time_point& start )
+{
+    return std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+}
+
+//
+// Returns the time per query in nanoseconds
+//
+template< class Find >
+static double Measure( const std::vector< double >& pt, Find find, size_t& check )
+{
+    auto start = std::chrono::steady_clock::now();
+    for( size_t i = 0; i < pt.size(); i++ )
+        check += find( pt[ i ] );
+
+    return 1E9 * Elapsed( start ) / pt.size();
+}
+
+
+int main( )
+{
+    const size_t queryNo = 1000000;
+    const size_t linearMax = 10000;
+    const double rc = 30;
+
+    std::vector< double > mono( queryNo ), rnd( queryNo );
+    for( size_t i = 0; i < queryNo; i++ )
+        mono[ i ] = rc * std::pow( ( i + 0.5 ) / queryNo, 3 );
+
+    srand( 1 );
+    for( size_t i = 0; i < queryNo; i++ )
+        rnd[ i ] = mono[ rand() % queryNo ];
+
+    size_t check = 0;
+
+    printf( "%-10s %16s %16s %16s\n", "Elements", "Monotone [ns]", "Random [ns]", "Linear [ns]" );
+
+    for( size_t eltNo = 10; eltNo <= 100000; eltNo *= 10 )
+    {
+        // Mesh graded towards the nucleus, as used for atoms
+        std::vector< double > x( eltNo + 1 );
+        std::vector< size_t > deg( eltNo, 2 );
+        for( size_t n = 0; n <= eltNo; n++ )
+            x[ n ] = rc * std::pow( double( n ) / eltNo, 2 );
+
+        Mesh mesh;
+        mesh.Set( x, deg );
+
+        size_t hint = 0;
+        auto findHint = [ &mesh, &hint ]( double r ) { return mesh.FindElt( r, hint ); };
+        auto find = [ &mesh ]( double r ) { return mesh.FindElt( r ); };
+        auto linear = [ &mesh ]( double r ) { return mesh.FindEltLinear( r ); };
+
+        const double tMono = Measure( mono, findHint, check );
+        const double tRnd = Measure( rnd, find, check );
+
+        if( eltNo <= linearMax )
+        {
+            const std::vector< double > part( rnd.begin(), rnd.begin() + queryNo / eltNo );
+            const double tLin = Measure( part, linear, check );
+            printf( "%-10zu %16.1f %16.1f %16.1f\n", eltNo, tMono, tRnd, tLin );
+        }
+        else
+            printf( "%-10zu %16.1f %16.1f %16s\n", eltNo, tMono, tRnd, "-" );
+    }
+
+    printf( "\n(checksum %zu)\n", check );
+
+    return 0;
+}
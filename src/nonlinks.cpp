@@ -11,7 +11,7 @@
 //
 void NonLinKs::Scf( )
 {
-    const size_t scfMaxIter = ParamDb::GetSize_t( "Scf_MaxIter" );
+    const size_t scfMaxIter = Config::Get().m_scfMaxIter;
     size_t iter = 1;
 
     m_rho.Init();
@@ -26,7 +26,24 @@ void NonLinKs::Scf( )
         m_pot.SetRho( m_rho );
         const EigResult eigResult = ks.Solve( m_pot );
 
-        if( IsFinished( eigResult ) || iter == scfMaxIter )
+        const bool finished = IsFinished( eigResult );
+
+        const PotCache& potCache = ks.GetPotCache();
+        printf( "*            PotCache: hit = %lu, miss = %lu\n",
+            static_cast< unsigned long >( potCache.HitNo() ),
+            static_cast< unsigned long >( potCache.MissNo() ) );
+        printf( "*            Poisson: passes = %lu, DOF = %lu, joined = %lu\n",
+            static_cast< unsigned long >( m_pot.Poisson().PassNo() ),
+            static_cast< unsigned long >( m_pot.Poisson().Dim() ),
+            static_cast< unsigned long >( m_pot.Poisson().JoinNo() ) );
+        ks.WriteDim( stdout );
+        if( !m_mix.IsLinear() )
+        {
+            printf( "*            Mix: history = %lu, residual = %E\n",
+                static_cast< unsigned long >( m_mix.HistoryNo() ), m_mix.ResidualNorm() );
+        }
+
+        if( finished || iter == scfMaxIter )
         {
             printf( "*  SCF-ITERATIONS = %lu\n", static_cast< unsigned long >( iter ) );
             printf( "***********   S C F   L O O P   F I N I S H E D   ***********\n" );
@@ -39,8 +56,26 @@ void NonLinKs::Scf( )
 
         const Rho rhoOld = m_rho;
 
-        const RhoMix mix( ks, rhoOld );
-        m_rho.Calc( mix );
+        // The new density is projected from the eigenvectors before mixing, hence
+        // the mixed density evaluates piecewise polynomials instead of the eigenfunctions
+        Approx rhoKsProj;
+        const Fun1D* rhoKs = &ks;
+        if( Config::Get().m_rhoSeedEig && ks.Project( rhoKsProj ) )
+            rhoKs = &rhoKsProj;
+
+        const RhoMix linMix( *rhoKs, rhoOld );
+        const Fun1D* mix = &linMix;
+        if( !m_mix.IsLinear() )
+        {
+            m_mix.Add( rhoOld, *rhoKs, ks.GetNode() );
+            mix = &m_mix;
+        }
+
+        // The density is approximated starting from the intervals where the eigenfunctions are polynomials
+        if( Config::Get().m_rhoSeedEig )
+            m_rho.Calc( *mix, ks.GetNode() );
+        else
+            m_rho.Calc( *mix );
 
         iter++;
     }
@@ -54,7 +89,7 @@ void NonLinKs::Scf( )
 //
 bool NonLinKs::IsFinished( const EigResult& eigResult ) const
 {
-    const double scfEnerDiff = ParamDb::GetDouble( "Scf_Diff" );
+    const double scfEnerDiff = Config::Get().m_scfDiff;
     static double sumOld = 0; // This variable MUST BE "static"
 
     const double sumNew = eigResult.EigenSum();
@@ -73,6 +108,7 @@ bool NonLinKs::IsFinished( const EigResult& eigResult ) const
 void NonLinKs::WriteResult( const KohnSham& ks, const EigResult& eigResult ) const
 {
     StateSet::WriteSates( stdout, eigResult );
+    ks.WriteMem( stdout );
 
     // Calculates required energy of atom
     Energy energy( m_pot, eigResult, m_rho.GetNode( ) );
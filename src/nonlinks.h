@@ -31,6 +31,8 @@
 //       \rho = scfMix * \rho_{cur} + ( 1.0 - scfMix ) * \rho_{old}
 //
 // 7. The mixing coefficient scfMix is defined by input parameter Scf_Mix. See the class RhoMix.
+//    The mixing with history of densities (Pulay, Anderson, Broyden) is selected by
+//    parameter Scf_MixEngine, see class ScfMix.
 //
 // 8. SCF procedure needs the input electron density for the very first iteration.
 //    This initial electron density is calculated by function Rho::Init()
@@ -43,6 +45,7 @@
 #include "rho.h"
 #include "pot.h"
 #include "kohnsham.h"
+#include "scfmix.h"
 
 
 
@@ -66,6 +69,9 @@ private:
 
     // Electron density
     Rho m_rho;
+
+    // Mixing of electron densities with history (if Scf_MixEngine is not "linear")
+    ScfMix m_mix;
 };
 
 #endif
@@ -74,6 +74,45 @@ bool ParamDb::GetBool( const std::string& param )
 }
 
 
+//
+// Returns "true", if parameter "param" is defined
+//
+bool ParamDb::Has( const std::string& param )
+{
+    return ( m_map.find( param ) != m_map.end() );
+}
+
+//
+// Returns value of optional parameter "param", or "def" if it is not defined
+//
+std::string ParamDb::GetString( const std::string& param, const std::string& def )
+{
+    return Has( param ) ? GetString( param ) : def;
+}
+
+//
+// Returns optional size_t
+//
+size_t ParamDb::GetSize_t( const std::string& param, size_t def )
+{
+    return Has( param ) ? GetSize_t( param ) : def;
+}
+
+//
+// Returns optional double
+//
+double ParamDb::GetDouble( const std::string& param, double def )
+{
+    return Has( param ) ? GetDouble( param ) : def;
+}
+
+//
+// Returns optional bool
+//
+bool ParamDb::GetBool( const std::string& param, bool def )
+{
+    return Has( param ) ? GetBool( param ) : def;
+}
 
 
 //
@@ -33,6 +33,13 @@ public:
     static long int    GetLong  ( const std::string& param );
     static bool        GetBool  ( const std::string& param );
 
+    // Optional parameters: the default value is returned if "param" is not defined
+    static bool        Has      ( const std::string& param );
+    static std::string GetString( const std::string& param, const std::string& def );
+    static size_t      GetSize_t( const std::string& param, size_t def );
+    static double      GetDouble( const std::string& param, double def );
+    static bool        GetBool  ( const std::string& param, bool def );
+
 private:
     static void ReadParams( const std::string& path );
     static void WriteParams();
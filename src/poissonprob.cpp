@@ -1,12 +1,15 @@
 #include <cassert>
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 #include <cstdio>
+#include <stdexcept>
 #include "poissonprob.h"
 #include "bndr.h"
-#include "paramdb.h"
+#include "config.h"
 #include "gauss.h"
 #include "lobatto.h"
+#include "eltkernel.h"
 
 
 //
@@ -14,9 +17,20 @@
 //
 void PoissonProb::Solve( const Fun1D& rho )
 {
-    const bool adapt = ParamDb::GetBool( "Solver_PsnAdapt" );
+    const bool adapt = Config::Get().m_psnAdapt;
+    const size_t cacheSize = Config::Get().m_psnCache;
 
-    DefineMesh( );
+    const bool keepMesh = Config::Get().m_psnKeepMesh;
+
+    m_cache.SetCapacity( cacheSize );
+    m_passNo = 0;
+    m_joinNo = 0;
+
+    // The adaptive algorithm starts from the (coarsened) mesh of the previous call
+    if( adapt && keepMesh && !m_y.empty() )
+        Coarsen( );
+    else
+        DefineMesh( );
 
     if( adapt )
     {
@@ -25,6 +39,7 @@ void PoissonProb::Solve( const Fun1D& rho )
     else
     {
         SolveNonAdapt( rho );
+        m_passNo++;
     }
 }
 
@@ -33,23 +48,59 @@ void PoissonProb::Solve( const Fun1D& rho )
 //
 void PoissonProb::DefineMesh( )
 {
-    const double rc      = ParamDb::GetDouble( "Atom_Rc" );
-    const size_t psnNode = ParamDb::GetSize_t( "Solver_PsnNode" );
-    const size_t psnDeg  = ParamDb::GetSize_t( "Solver_PsnDeg" );
+    const double rc      = Config::Get().m_rc;
+    const size_t psnNode = Config::Get().m_psnNode;
+    const size_t psnDeg  = Config::Get().m_psnDeg;
 
-    m_mesh.GenLin( 0, rc, psnNode, psnDeg );
+    m_mesh.Gen( Config::Get().m_psnMesh, 0, rc, psnNode, psnDeg, Config::Get().m_psnMeshR0 );
     m_mesh.CreateCnnt( BndrType_Dir, BndrType_Dir );
 }
 
 
+//
+// Joins the pairs of elements, which were obtained by division of one element,
+// if their indicators for the last solution are much less than the required accuracy,
+// see Mesh::Coarsen.
+//
+void PoissonProb::Coarsen( )
+{
+    std::vector< double > ind;
+    Indicator( ind );
+
+    m_joinNo = m_mesh.Coarsen( ind, Config::Get().m_psnAbsMaxCoef );
+    if( m_joinNo > 0 )
+        m_mesh.CreateCnnt( BndrType_Dir, BndrType_Dir );
+}
+
 //
 // Solves the problem (WITHOUT adaptation)
 //
+// The stiffness matrix does not depend on the electron density.
+// Hence, it is assembled and factorized only if the mesh was not seen before.
+// Otherwise, the cached factorization is used and only the load vector is assembled.
+//
 void PoissonProb::SolveNonAdapt( const Fun1D& rho )
 {
-    Malloc();
-    Assemble( rho );
-    m_s.SolveSymPos( m_b, m_y );
+    const bool checked = Config::Get().m_symPosChecked;
+
+    size_t id = m_cache.Find( m_mesh );
+    if( id == StiffCache::NOT_FOUND )
+    {
+        AssembleS( );
+        id = m_cache.Add( m_mesh, m_s );
+    }
+
+    AssembleB( rho );
+
+    if( checked )
+    {
+        ClpMtxBand s = m_cache.Mtx( id );
+        s.SolveSymPosChecked( m_b, m_y );
+    }
+    else
+    {
+        m_cache.Chol( id ).Solve( m_b, m_y );
+    }
 }
 
 //
@@ -57,32 +108,49 @@ void PoissonProb::SolveNonAdapt( const Fun1D& rho )
 //
 void PoissonProb::SolveAdapt( const Fun1D& rho )
 {
-    const double absMaxCoef = ParamDb::GetDouble( "Solver_PsnAbsMaxCoef" );
+    const double absMaxCoef = Config::Get().m_psnAbsMaxCoef;
+
+    const bool hp = Config::Get().m_psnHp;
+    const size_t maxDeg = Config::Get().m_hpMaxDeg;
 
-    std::vector< size_t > eltToSplit( 1 );
+    std::vector< double > ind;
+    std::vector< size_t > eltToMark, eltToSplit, eltToRaise;
 
     while( true )
     {
         SolveNonAdapt( rho );
-        const EltInfo eltInfo = MaxMinCoef( );
+        m_passNo++;
 
-        if( eltInfo.GetMaxMinCoef() < absMaxCoef )
+        Indicator( ind );
+        if( *std::max_element( ind.begin(), ind.end() ) < absMaxCoef )
             break;
 
-        eltToSplit[ 0 ] = eltInfo.GetEltId();
+        Mark( ind, absMaxCoef, eltToMark );
 
+        // hp-adaptivity: the degree of smooth element is increased instead of its division
+        eltToSplit.clear();
+        eltToRaise.clear();
+        for( size_t n : eltToMark )
+        {
+            if( hp && m_mesh.Elt( n ).P() < maxDeg && IsSmooth( n ) )
+                eltToRaise.push_back( n );
+            else
+                eltToSplit.push_back( n );
+        }
+
+        m_mesh.Raise( eltToRaise );
         m_mesh.AddToMesh( eltToSplit );
         m_mesh.CreateCnnt( BndrType_Dir, BndrType_Dir );
     }
 }
 
 //
-// Finds the element with the largest coefficient contained in the minimal coefficients
-// BUBBLE functins are considered only.
+// Calculates the indicator of each element: the smallest absolute value
+// of the coefficients of BUBBLE functions.
 //
-EltInfo PoissonProb::MaxMinCoef( ) const
+void PoissonProb::Indicator( std::vector< double >& ind ) const
 {
-    EltInfo eltInfo;
+    ind.assign( m_mesh.EltNo(), 0 );
 
     for( size_t n = 0; n < m_mesh.EltNo(); n++ ) // For each element
     {
@@ -100,39 +168,91 @@ EltInfo PoissonProb::MaxMinCoef( ) const
                 minCoef = coef;
         }
 
-        // Set the largest coefficient with minimal coefficients
-        if( minCoef > eltInfo.GetMaxMinCoef() )
-        {
-            eltInfo.Set( minCoef, n );
-        }
+        ind[ n ] = minCoef;
     }
-
-    return eltInfo;
 }
 
+//
+// Returns "true" if the coefficients of bubble functions on element "n"
+// decay faster than Solver_HpDecay, see Lobatto::Decay.
+//
+bool PoissonProb::IsSmooth( size_t n ) const
+{
+    const Element& e = m_mesh.Elt( n );
+    std::vector< double > bubble( e.P() - 1 );
+
+    for( size_t j = 1; j < e.DofNo() - 1; j++ )
+        bubble[ j - 1 ] = fabs( m_y[ e.m_dof[ j ] ] );
 
+    return Lobatto::Decay( bubble.data(), bubble.size() ) < Config::Get().m_hpDecay;
+}
 
 //
-// Allocates the required memory
+// Selects the elements to be divided, based on their indicators "ind",
+// see item 14 in the header file. The elements with indicator less than "tol"
+// are never selected.
 //
-void PoissonProb::Malloc()
+void PoissonProb::Mark( const std::vector< double >& ind, double tol, std::vector< size_t >& eltToSplit )
 {
-    const size_t M = m_mesh.Dim( BndrType_Dir, BndrType_Dir );
-    const size_t band = m_mesh.GetBand();
+    const double theta = Config::Get().m_psnMarkTheta;
 
-    m_s.Assign( M, band, 0, 0 );
-    m_b.assign( M, 0 );
-    m_y.assign( M, 0);
+    const size_t nMax = std::max_element( ind.begin(), ind.end() ) - ind.begin();
+    eltToSplit.clear();
+
+    switch( Config::Get().m_psnMark )
+    {
+    case PsnMark_Max:
+    {
+        const double limit = std::max( tol, theta * ind[ nMax ] );
+        for( size_t n = 0; n < ind.size(); n++ )
+        {
+            if( ind[ n ] >= limit )
+                eltToSplit.push_back( n );
+        }
+        break;
+    }
+    case PsnMark_Dorfler:
+    {
+        double total = 0;
+        std::vector< size_t > order;
+        for( size_t n = 0; n < ind.size(); n++ )
+        {
+            total += ind[ n ] * ind[ n ];
+            if( ind[ n ] >= tol )
+                order.push_back( n );
+        }
+
+        std::sort( order.begin(), order.end(), [ &ind ]( size_t i, size_t j ) { return ind[ i ] > ind[ j ]; } );
+
+        double sum = 0;
+        for( size_t k = 0; k < order.size() && sum < theta * total; k++ )
+        {
+            eltToSplit.push_back( order[ k ] );
+            sum += ind[ order[ k ] ] * ind[ order[ k ] ];
+        }
+        break;
+    }
+    case PsnMark_Single:
+        eltToSplit.push_back( nMax );
+        break;
+    }
 }
 
 
+
 //
-// Assembling algorithm for equation solving
+// Assembling algorithm for stiffness matrix
 //
-void PoissonProb::Assemble( const Fun1D& rho )
+void PoissonProb::AssembleS( )
 {
+    const size_t M = m_mesh.Dim( BndrType_Dir, BndrType_Dir );
+    const size_t band = m_mesh.GetBand();
     const size_t N = m_mesh.EltNo(); // Number of elements
 
+    m_s.Assign( M, band, 0, 0 );
+
+    // Local stiffness matrix
+    std::vector< double > sLoc;
 
     // Element loop
     for( size_t n = 0; n < N; n++ )
@@ -140,6 +260,9 @@ void PoissonProb::Assemble( const Fun1D& rho )
         const Element& e = m_mesh.Elt( n );
         const size_t DofNo = e.DofNo();
 
+        sLoc.resize( DofNo * DofNo );
+        EltKernel::Psn( e.P(), e.Jac(), &sLoc.front() );
+
         // Loop over basis functions
         for( size_t i = 0; i < DofNo; i++)
         {
@@ -147,55 +270,65 @@ void PoissonProb::Assemble( const Fun1D& rho )
             if(ni < 0)
                 continue;
 
-            const size_t psiI = e.PsiId( i );
-
             // Loop over basis functions
             for( size_t j = i; j < DofNo; j++ )
             {
-                const size_t psiJ = e.PsiId( j );
-
                 const int nj = e.m_dof[ j ];
                 if(nj > -1)
-                    m_s.Set( ni, nj ) += CalcS( e, psiI, psiJ );
+                    m_s.Set( ni, nj ) += sLoc[ i * DofNo + j ];
                 //else // Dirichlet boundary conditions are ZERO, hence it can be skiped
                 //	m_b->Set(ni) -= bndr[-nj] * CalcS(e, psiI, psiJ);
             }
-
-            // Contribution of the vertex basis function $v_{m_1}$ to the right hand side $b$
-            m_b[ ni ] += CalcB( rho, e, psiI );
         }
     }
 }
 
 //
-// Returns the element $b[i]$ of load matrix element.
-// Gauss quadrature applied.
+// Assembling algorithm for load vector
 //
-double PoissonProb::CalcB( const Fun1D& rho, const Element& e, size_t ni ) const
+void PoissonProb::AssembleB( const Fun1D& rho )
 {
-    double b = 0;
+    const size_t M = m_mesh.Dim( BndrType_Dir, BndrType_Dir );
+    const size_t N = m_mesh.EltNo(); // Number of elements
+
+    m_b.assign( M, 0 );
+    m_y.assign( M, 0 );
+
+    // Quadrature nodes and quadrature weights multiplied by the right hand side at these nodes
+    std::vector< double > r( Gauss::Size() ), wRho( Gauss::Size() );
+
+    // Local load vector
+    std::vector< double > bLoc;
 
-    for( size_t n = 0; n < Gauss::Size(); n++ )
+    // Element loop
+    for( size_t n = 0; n < N; n++ )
     {
-        const double s = Gauss::X( n );
-        const double w = Gauss::W( n );
-        const double r = e.X( s );
-        b += w * Lobatto::Basis( ni, s ) * rho.Get( r ) / r;
-    }
-    return e.Jac() * b;
-}
+        const Element& e = m_mesh.Elt( n );
+        const size_t DofNo = e.DofNo();
+        const double jac = e.Jac();
 
-//
-// Returns the element $e[i][j]$ stiffness matrix element.
-// The elements are read from precomputed array.
-//
-double PoissonProb::CalcS( const Element& e, size_t ni, size_t nj ) const
-{
-    const double gamma = 1;
-    const double v1 = gamma * Lobatto::GetS( ni, nj );
+        // The electron density is evaluated once per element, for all quadrature nodes at once
+        for( size_t q = 0; q < r.size(); q++ )
+            r[ q ] = e.X( Gauss::X( q ) );
+        rho.Get( &r.front(), r.size(), &wRho.front() );
+
+        for( size_t q = 0; q < wRho.size(); q++ )
+            wRho[ q ] = Gauss::W( q ) * wRho[ q ] / r[ q ];
 
-    const double jac = e.Jac();
-    return v1 / jac;
+        bLoc.resize( DofNo );
+        EltKernel::Load( e.P(), &wRho.front(), &bLoc.front() );
+
+        // Loop over basis functions
+        for( size_t i = 0; i < DofNo; i++)
+        {
+            const int ni = e.m_dof[ i ];
+            if(ni < 0)
+                continue;
+
+            // Contribution of the vertex basis function $v_{m_1}$ to the right hand side $b$
+            m_b[ ni ] += jac * bLoc[ i ];
+        }
+    }
 }
 
 //
@@ -211,22 +344,14 @@ double PoissonProb::GetUh( double r ) const
     const double s = e.Xinv( r );
 
     // Sum over all basis function with support on the element $e$
-    double val = 0;
-
-
     // It works only with zero Dirichlet bpundary conditions
-    for( size_t i = 0; i < e.m_dof.size(); i++ )
+    auto coef = [ this, &e ]( size_t k )
     {
-        const int m = e.m_dof[ i ];
-        if( m < 0 )
-            continue;
-        const size_t psiI = e.PsiId( i );
+        const int m = e.m_dof[ e.LocalId( k ) ];
+        return ( m < 0 ) ? 0. : m_y[ m ];
+    };
 
-        val += m_y[ m ] * Lobatto::Basis( psiI, s );
-    }
-
-
-    return val;
+    return Lobatto::Expand( e.P(), s, coef );
 }
 
 double PoissonProb::GetVh( double r ) const
@@ -234,8 +359,8 @@ double PoissonProb::GetVh( double r ) const
     assert( r > 0 );
     const double val = GetUh( r );
 
-    const double z = ParamDb::GetDouble( "Atom_Proton" );
-    const double rc = ParamDb::GetDouble( "Atom_Rc" );
+    const double z = static_cast< double >( Config::Get().m_proton );
+    const double rc = Config::Get().m_rc;
 
     // Apply non-zero Dirichlet boundary conditions
     const double ua = 0, ub = z, a = 0, b = rc;
@@ -243,3 +368,60 @@ double PoissonProb::GetVh( double r ) const
 
     return ( val + alpha * r + beta ) / r;
 }
+
+//
+// Returns the values of the solution at points r[0], ..., r[n-1].
+// The element is located once for the consecutive points lying in it.
+//
+void PoissonProb::GetUh( const double* r, size_t n, double* val ) const
+{
+    // The element found last, the search for the next run starts from it
+    size_t hint = 0;
+
+    size_t i = 0;
+    while( i < n )
+    {
+        // Otherwise no point would be consumed (it also rejects NaN)
+        if( !m_mesh.IsInRange( r[ i ] ) )
+        {
+            throw std::runtime_error( "Point out of range in 'PoissonProb::GetUh'" );
+        }
+
+        const size_t k = m_mesh.FindElt( r[ i ], hint );
+        const Element& e = m_mesh.Elt( k );
+        const double xa = m_mesh.X( k );
+        const double xb = m_mesh.X( k + 1 );
+
+        // It works only with zero Dirichlet bpundary conditions
+        auto coef = [ this, &e ]( size_t j )
+        {
+            const int m = e.m_dof[ e.LocalId( j ) ];
+            return ( m < 0 ) ? 0. : m_y[ m ];
+        };
+
+        // Following points in the same element
+        for( ; i < n && xa <= r[ i ] && r[ i ] <= xb; i++ )
+            val[ i ] = Lobatto::Expand( e.P(), e.Xinv( r[ i ] ), coef );
+    }
+}
+
+//
+// Returns the values of Hartree potential at points r[0], ..., r[n-1]
+//
+void PoissonProb::GetVh( const double* r, size_t n, double* val ) const
+{
+    GetUh( r, n, val );
+
+    const double z = static_cast< double >( Config::Get().m_proton );
+    const double rc = Config::Get().m_rc;
+
+    // Apply non-zero Dirichlet boundary conditions
+    const double ua = 0, ub = z, a = 0, b = rc;
+    const double alpha = ( ub - ua ) / ( b - a ), beta = ua - a * alpha;
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        assert( r[ i ] > 0 );
+        val[ i ] = ( val[ i ] + alpha * r[ i ] + beta ) / r[ i ];
+    }
+}
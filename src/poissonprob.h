@@ -70,13 +70,40 @@
 //        a) adaptive
 //        b) non-adaptive
 //
+// 14. In the adaptive algorithm the elements are divided until the indicator of each element
+//     is less than Solver_PsnAbsMaxCoef. The indicator of element is the smallest absolute value
+//     of the coefficients of its bubble functions. The elements divided in one pass are defined
+//     by the marking strategy (parameter Solver_PsnMark):
+//        a) "single"  - the element with the largest indicator,
+//        b) "max"     - all elements with indicator greater than theta times the largest indicator,
+//        c) "dorfler" - the smallest set of elements with the largest indicators, such that
+//                       the sum of their squared indicators is at least theta times the sum
+//                       for all elements.
+//     The fraction theta is defined by parameter Solver_PsnMarkTheta. Only the elements with
+//     indicator not less than Solver_PsnAbsMaxCoef are divided.
+//
+// 15. The electron density changes a little between SCF iterations. Hence, the adaptive
+//     algorithm starts from the mesh of the previous call (parameter Solver_PsnKeepMesh).
+//     Before that, the pairs of elements obtained by division of one element are joined,
+//     if their indicators (for the previous density) are much less than Solver_PsnAbsMaxCoef.
+//     Hence, the mesh is coarsened, when the tail of the density moves.
+//
+// 16. If parameter Solver_PsnRefine is "hp", the degree of marked element is increased
+//     instead of its division, if the coefficients of its bubble functions decay fast,
+//     see Lobatto::Decay.
+//
+// 17. The stiffness matrix depends on the mesh only. The factorized stiffness matrices
+//     are cached, see class StiffCache. Hence, for the mesh used in the previous
+//     SCF iterations only the load vector is assembled.
+//
 // Zbigniew Romanowski [ROMZ@wp.pl]
 //
 
 #include "fun1D.h"
 #include "mesh.h"
-#include "eltinfo.h"
+#include <vector>
 #include "clpmtxband.h"
+#include "stiffcache.h"
 
 
 class PoissonProb
@@ -87,18 +114,26 @@ public:
     void Solve( const Fun1D& rho );
     double GetUh( double r ) const;
     double GetVh( double r ) const;
+    void GetUh( const double* r, size_t n, double* val ) const;
+    void GetVh( const double* r, size_t n, double* val ) const;
+
+    // Number of solutions in the last call of Solve, and the dimension of the last solution
+    size_t PassNo() const { return m_passNo; }
+    size_t JoinNo() const { return m_joinNo; }
+    size_t Dim() const { return m_y.size(); }
 
 private:
     void DefineMesh();
+    void Coarsen();
     void SolveNonAdapt( const Fun1D& rho );
     void SolveAdapt( const Fun1D& rho );
 
-    EltInfo MaxMinCoef() const;
-    void Malloc();
-    void Assemble( const Fun1D& rho );
+    void Indicator( std::vector< double >& ind ) const;
+    bool IsSmooth( size_t n ) const;
+    static void Mark( const std::vector< double >& ind, double tol, std::vector< size_t >& eltToSplit );
+    void AssembleS();
+    void AssembleB( const Fun1D& rho );
 
-    double CalcB( const Fun1D& rho, const Element& e, size_t ni ) const;
-    double CalcS( const Element& e, size_t ni, size_t nj ) const;
 
 
 private:
@@ -108,11 +143,20 @@ private:
     // Stifness matrix
     ClpMtxBand m_s;
 
+    // Factorized stiffness matrices for the meshes used before
+    StiffCache m_cache;
+
     // Right hand side vektor for equation Sy = b
     std::vector< double > m_b;
 
     // Coefficient vector y.
     std::vector< double > m_y;
+
+    // Number of solutions in the last call of Solve
+    size_t m_passNo = 0;
+
+    // Number of elements joined in the last call of Solve
+    size_t m_joinNo = 0;
 };
 
 
@@ -1,16 +1,17 @@
 #include <cassert>
+#include <vector>
 #include "pot.h"
 #include "exchslater.h"
 #include "corrvwn.h"
 #include "constants.h"
-#include "paramdb.h"
+#include "config.h"
 #include <stdexcept>
 
 //
 // Constructor
 //
 Pot::Pot( )
-    : m_z( ParamDb::GetDouble( "Atom_Proton" ) )
+    : m_z( static_cast< double >( Config::Get().m_proton ) )
 {
     SetXc( );
 }
@@ -43,6 +44,39 @@ double Pot::Get( double r ) const
     return vx + vc + vn + vh;
 }
 
+//
+// Returns effective potential for radial Kohn-Sham equation for radii r[0], ..., r[n-1].
+// Electron density and Hartree potential are evaluated for all points at once.
+//
+void Pot::Get( const double* r, size_t n, double* val ) const
+{
+    std::vector< double > vh( n );
+    m_rho.Get( r, n, val );
+    Vh( r, n, &vh.front() );
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        assert( r[ i ] > 0 );
+
+        const double rhoVal = val[ i ] / ( RATOM_4PI * r[ i ] * r[ i ] );
+        assert( rhoVal >= 0 );
+
+        const double vn = Vn( r[ i ] );
+        const double vx = Vx( rhoVal, 0 );
+        const double vc = Vc( rhoVal, 0 );
+
+        val[ i ] = vx + vc + vn + vh[ i ];
+    }
+}
+
+//
+// Returns values of electron density for radii r[0], ..., r[n-1]
+//
+void Pot::GetRho( const double* r, size_t n, double* val ) const
+{
+    m_rho.Get( r, n, val );
+}
+
 //
 // Sets the new electron density
 //
@@ -90,6 +124,14 @@ double Pot::Vh( double r ) const
     return m_poisson.GetVh( r );
 }
 
+//
+// Hartree potential for radii r[0], ..., r[n-1]
+//
+void Pot::Vh( const double* r, size_t n, double* val ) const
+{
+    m_poisson.GetVh( r, n, val );
+}
+
 //
 // Density of exchnage energy
 //
@@ -126,8 +168,8 @@ double Pot::XcEdiffV( double r ) const
 //
 void Pot::SetXc( )
 {
-    const std::string exch = ParamDb::GetString( "XC_Exch" );
-    const std::string corr = ParamDb::GetString( "XC_Corr" );
+    const std::string exch = Config::Get().m_exch;
+    const std::string corr = Config::Get().m_corr;
 
     if( exch == "slater" )
     {
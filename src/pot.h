@@ -28,19 +28,24 @@ public:
     void SetRho( const Rho& rho );
 
     virtual double Get( double r ) const;
+    virtual void Get( const double* r, size_t n, double* val ) const;
     double GetRho( double r ) const;
+    void GetRho( const double* r, size_t n, double* val ) const;
 
 
     double Vn( double r ) const;
     double Vx( double rho, double rhoDer ) const;
     double Vc( double rho, double rhoDer ) const;
     double Vh( double r ) const;
+    void Vh( const double* r, size_t n, double* val ) const;
 
     double Ex( double rho, double rhoDer ) const;
     double Ec( double rho, double rhoDer ) const;
 
     double XcEdiffV( double r ) const;
 
+    const PoissonProb& Poisson() const { return m_poisson; }
+
 private:
     void SetXc( );
 
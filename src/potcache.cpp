@@ -0,0 +1,65 @@
+#include <cassert>
+#include <algorithm>
+#include "potcache.h"
+#include "gauss.h"
+
+
+//
+// Constructor
+//
+PotCache::PotCache()
+    : m_pot( nullptr )
+    , m_hitNo( 0 )
+    , m_missNo( 0 )
+{
+}
+
+//
+// Removes all values and sets the new potential
+//
+void PotCache::Reset( const Fun1D& pot )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    m_pot = &pot;
+    m_index.clear();
+    m_val.clear();
+    m_hitNo = 0;
+    m_missNo = 0;
+}
+
+//
+// Returns values of the potential val[0], ..., val[Q-1] at the quadrature nodes
+// r[0], ..., r[Q-1] of element [a, b], where Q = Gauss::Size().
+// The potential is evaluated, if the element is not found in the cache.
+//
+void PotCache::Get( double a, double b, const double* r, double* val )
+{
+    assert( m_pot );
+    const size_t Q = Gauss::Size();
+    const std::pair< double, double > key( a, b );
+
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        const auto it = m_index.find( key );
+        if( it != m_index.end() )
+        {
+            m_hitNo++;
+            std::copy( m_val.begin() + it->second, m_val.begin() + it->second + Q, val );
+            return;
+        }
+    }
+
+    // The potential is evaluated outside the lock. It is allowed, because
+    // Fun1D::Get of the potential modifies no state, see item 5 in the header.
+    m_pot->Get( r, Q, val );
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    // Another thread could add the same element in the meantime
+    if( m_index.insert( std::make_pair( key, m_val.size() ) ).second )
+        m_val.insert( m_val.end(), val, val + Q );
+
+    m_missNo++;
+}
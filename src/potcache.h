@@ -0,0 +1,68 @@
+#ifndef RATOM_POTCACHE_H
+#define RATOM_POTCACHE_H
+
+//
+// 1. Cache of the effective potential at the quadrature nodes of elements.
+//
+// 2. The potential is needed at all quadrature nodes of each element, when the matrices
+//    of the eigenvalue problem are assembled. The assembly is repeated for each angular
+//    quantum number "ell" and for each step of the adaptive procedure. The meshes for
+//    different "ell" are obtained by division of elements of the same initial mesh,
+//    hence many elements are common to them. Moreover, only the divided elements are
+//    new after the adaptive step.
+//
+// 3. The key of the cache is the element, defined by its end points.
+//    For each element the values of the potential at all quadrature nodes
+//    (see class Gauss) are stored.
+//
+// 4. The cache is valid for one potential, i.e. for one SCF iteration.
+//    Function Reset must be called when the potential is changed.
+//
+// 5. The cache is shared by the threads solving the eigenvalue problems, see KohnSham::SolveParallel.
+//    The map and the stored values are protected by the mutex. The potential is evaluated
+//    outside the lock, hence function Get of the potential (and of all objects it calls:
+//    Rho, Approx, PoissonProb, Mesh) must be reentrant, i.e. it must not modify any state.
+//
+// Zbigniew Romanowski [ROMZ@wp.pl]
+//
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "fun1D.h"
+
+
+class PotCache
+{
+public:
+    PotCache();
+    ~PotCache() = default;
+
+    void Reset( const Fun1D& pot );
+    void Get( double a, double b, const double* r, double* val );
+
+    const Fun1D& Pot() const { return *m_pot; }
+
+    size_t HitNo() const { return m_hitNo; }
+    size_t MissNo() const { return m_missNo; }
+
+private:
+    // Potential for which the values are stored
+    const Fun1D* m_pot;
+
+    // Position in "m_val" of the values for element [a, b]
+    std::map< std::pair< double, double >, size_t > m_index;
+
+    // Values of the potential, Gauss::Size() values for each element
+    std::vector< double > m_val;
+
+    // Number of elements found in the cache and not found in the cache
+    size_t m_hitNo;
+    size_t m_missNo;
+
+    std::mutex m_mutex;
+};
+
+#endif
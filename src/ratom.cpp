@@ -1,7 +1,10 @@
 #include "ratom.h"
 
 
-RAtom::RAtom( const std::string& path ) : m_db( path )
+RAtom::RAtom( const std::string& path )
+    : m_db( path )
+    , m_lobatto( Config::Get().m_maxDeg )
+    , m_gauss( Config::Get().m_maxDeg )
 {
 
 
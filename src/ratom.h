@@ -36,6 +36,7 @@
 //
 
 #include "paramdb.h"
+#include "config.h"
 #include "nonlinks.h"
 #include "lobatto.h"
 #include "gauss.h"
@@ -50,8 +51,9 @@ public:
     void Run( );
 
 private:
-    // These three objects must be created
+    // These objects must be created (in this order)
     ParamDb m_db;
+    Config m_config;
     Lobatto m_lobatto;
     Gauss m_gauss;
     StateSet m_stateSet;
@@ -5,7 +5,8 @@
 #include "constants.h"
 #include "approxsolver.h"
 #include "gauss.h"
-#include "paramdb.h"
+#include "config.h"
+#include "mesh.h"
 
 
 //
@@ -32,8 +33,8 @@
 //
 void Rho::Init()
 {
-    const bool def = ParamDb::GetBool( "Rho0_Default" );
-    const double M = ParamDb::GetDouble( "Atom_Proton" );
+    const bool def = Config::Get().m_rho0Default;
+    const double M = static_cast< double >( Config::Get().m_proton );
     const double midM = 50; // This is heuristic!
     double c, alpha;
 
@@ -52,8 +53,8 @@ void Rho::Init()
     else // User defined initialization
     {
 
-        c = ParamDb::GetDouble( "Rho0_c" );
-        alpha = ParamDb::GetDouble( "Rho0_Alpha" );
+        c = Config::Get().m_rho0C;
+        alpha = Config::Get().m_rho0Alpha;
     }
 
     RhoInit f( c, alpha );
@@ -78,8 +79,8 @@ void Rho::Init()
         {
             std::stringstream ss;
             ss << "Invalid arguments for user defined initialization of electron density." << std::endl;
-            ss << "Applied parameter Rho0_c = " << ParamDb::GetDouble( "Rho0_c" ) << std::endl;
-            ss << "and parameter Rho0_Alpha = " << ParamDb::GetDouble( "Rho0_Alpha" ) << std::endl;
+            ss << "Applied parameter Rho0_c = " << Config::Get().m_rho0C << std::endl;
+            ss << "and parameter Rho0_Alpha = " << Config::Get().m_rho0Alpha << std::endl;
             ss << "give wrong number of electrons! It must be: " << M << std::endl;
             ss << "Applied parameters gave: " << elecNo << std::endl;
             ss << "Adjust parameters Rho0_c, Rho0_Alpha and try again." << std::endl;
@@ -110,20 +111,45 @@ double Rho::Integ() const
 //
 void Rho::Calc( const Fun1D& f )
 {
-    const double rc			= ParamDb::GetDouble( "Atom_Rc" );
-    const size_t rhoDeg		= ParamDb::GetSize_t( "Rho_Deg" );
-    const double rhoDelta	= ParamDb::GetDouble( "Rho_Delta" );
+    const double rc			= Config::Get().m_rc;
+    const size_t rhoDeg		= Config::Get().m_rhoDeg;
+    const double rhoDelta	= Config::Get().m_rhoDelta;
 
     ApproxSolver approxSolver( rhoDeg, f );
+
+    // For the graded mesh the approximation starts from its elements
+    const MeshType type = Config::Get().m_rhoMesh;
+    if( type != MeshType_Lin )
+    {
+        std::vector< double > node;
+        Mesh::GenNode( type, 0, rc, Config::Get().m_rhoNode, Config::Get().m_rhoMeshR0, node );
+        m_approx = approxSolver.Run( node, rhoDelta );
+        return;
+    }
+
     m_approx = approxSolver.Run( 0, rc, rhoDelta );
 }
 
+//
+// Calculates approximation of electron density based on function "f",
+// which is a polynomial between consecutive nodes "node" (approximately).
+// The approximation starts from these intervals, instead of the whole interval [0, Rc].
+//
+void Rho::Calc( const Fun1D& f, const std::vector< double >& node )
+{
+    const size_t rhoDeg		= Config::Get().m_rhoDeg;
+    const double rhoDelta	= Config::Get().m_rhoDelta;
+
+    ApproxSolver approxSolver( rhoDeg, f );
+    m_approx = approxSolver.Run( node, rhoDelta );
+}
+
 //
 // Returns electron density for radius "r"
 //
 double Rho::Get( double r ) const
 {
-    assert( r <= ParamDb::GetDouble( "Atom_Rc" ) );
+    assert( r <= Config::Get().m_rc );
 
     const double v = m_approx.Get( r );
 
@@ -135,6 +161,21 @@ double Rho::Get( double r ) const
     return v;
 }
 
+//
+// Returns electron density for radii r[0], ..., r[n-1]
+//
+void Rho::Get( const double* r, size_t n, double* val ) const
+{
+    m_approx.Get( r, n, val );
+
+    // See function Rho::Get( double r )
+    for( size_t i = 0; i < n; i++ )
+    {
+        if( val[ i ] < 0. )
+            val[ i ] = 0;
+    }
+}
+
 //
 // Returns value of helper function $\tilde{\rho}(r)$
 //
@@ -166,7 +207,7 @@ std::vector< double > Rho::GetNode() const
 //
 void Rho::Write() const
 {
-    const std::string outRhoPath = ParamDb::GetString( "Out_RhoPath" );
+    const std::string outRhoPath = Config::Get().m_outRhoPath;
     std::ofstream out( outRhoPath, std::ios::out );
     if( !out )
     {
@@ -174,7 +215,7 @@ void Rho::Write() const
     }
     out << std::scientific;
 
-    const size_t outRhoNode = ParamDb::GetSize_t( "Out_RhoNode" );
+    const size_t outRhoNode = Config::Get().m_outRhoNode;
     if( outRhoNode < 1 )
     {
         throw std::runtime_error( "Out_RhoNode must be greater then zero." );
@@ -200,6 +241,9 @@ void Rho::Write() const
     }
 
 
+    // Radii and the density in one interval
+    std::vector< double > rr( outRhoNode ), val( outRhoNode );
+
     double r;
     for( size_t i = 0; i < node.size() - 1; ++i )
     {
@@ -207,9 +251,19 @@ void Rho::Write() const
         r = node[ i ];
         for( size_t k = 0; k < outRhoNode; ++k )
         {
-            out  << r << " " << Get( r ) << " " << GetRhoTilde( r ) << std::endl;
+            rr[ k ] = r;
             r += dr;
         }
+
+        // The density is evaluated for all points in the interval at once
+        Get( &rr.front(), outRhoNode, &val.front() );
+
+        for( size_t k = 0; k < outRhoNode; ++k )
+        {
+            const double rho = val[ k ];
+            const double rhoTilde = ( rr[ k ] > 0 ) ? rho / ( RATOM_4PI * rr[ k ] * rr[ k ] ) : GetRhoTilde( rr[ k ] );
+            out  << rr[ k ] << " " << rho << " " << rhoTilde << std::endl;
+        }
     }
 
     // The last node
@@ -21,7 +21,9 @@ public:
     virtual ~Rho() = default;
 
     virtual double Get( double r ) const;
+    virtual void Get( const double* r, size_t n, double* val ) const;
     void Calc( const Fun1D& f );
+    void Calc( const Fun1D& f, const std::vector< double >& node );
     void Init();
     std::vector< double > GetNode() const;
     void Write() const;
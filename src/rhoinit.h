@@ -20,6 +20,11 @@ public:
     {
         return r * r * m_c * exp(-m_alpha * r);
     }
+    virtual void Get(const double* r, size_t n, double* val) const
+    {
+        for(size_t i = 0; i < n; i++)
+            val[i] = r[i] * r[i] * m_c * exp(-m_alpha * r[i]);
+    }
 public:
     double m_c, m_alpha;
 };
@@ -8,8 +8,9 @@
 // Zbigniew Romanowski [ROMZ@wp.pl]
 //
 
+#include <vector>
 #include "fun1D.h"
-#include "paramdb.h"
+#include "config.h"
 
 
 class RhoMix : public Fun1D
@@ -18,7 +19,7 @@ public:
     RhoMix( const Fun1D& rhoCur, const Fun1D& rhoOld)
         : m_rhoCur( rhoCur ), m_rhoOld( rhoOld )
     {
-        m_scfMix = ParamDb::GetDouble( "Scf_Mix" );
+        m_scfMix = Config::Get().m_scfMix;
     }
 
     virtual ~RhoMix() = default;
@@ -33,6 +34,16 @@ public:
         return m_scfMix * cur + ( 1.0 - m_scfMix ) * old;
     }
 
+    virtual void Get( const double* r, size_t n, double* val ) const
+    {
+        std::vector< double > old( n );
+        m_rhoCur.Get( r, n, val );
+        m_rhoOld.Get( r, n, &old.front() );
+
+        for( size_t i = 0; i < n; i++ )
+            val[ i ] = m_scfMix * val[ i ] + ( 1.0 - m_scfMix ) * old[ i ];
+    }
+
 private:
     // Current elevron density
     const Fun1D& m_rhoCur;
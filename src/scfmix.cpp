@@ -0,0 +1,271 @@
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include "scfmix.h"
+#include "config.h"
+#include "gauss.h"
+#include "clpmtx.h"
+
+//
+// Constructor
+//
+ScfMix::ScfMix()
+    : m_engine( Config::Get().m_scfMixEngine )
+    , m_historyMax( Config::Get().m_scfMixHistory )
+    , m_restart( Config::Get().m_scfMixRestart )
+    , m_beta( Config::Get().m_scfMix )
+    , m_addNo( 0 )
+    , m_resNorm( 0 )
+{
+    // Anderson mixing uses the last two iterations only
+    if( m_engine == MixEngine_Anderson )
+        m_historyMax = std::min( m_historyMax, static_cast< size_t >( 2 ) );
+}
+
+//
+// Adds the next SCF iteration: input density "rhoIn" and output density "rhoOut".
+// The output density is a polynomial between consecutive nodes "node" (approximately).
+// Then the coefficients of the new input density are calculated.
+//
+void ScfMix::Add( const Rho& rhoIn, const Fun1D& rhoOut, const std::vector< double >& node )
+{
+    m_in.push_back( rhoIn );
+    m_out.emplace_back();
+    m_out.back().Calc( rhoOut, node );
+
+    while( m_in.size() > m_historyMax )
+    {
+        m_in.pop_front();
+        m_out.pop_front();
+    }
+
+    m_addNo++;
+    if( m_restart > 0 && m_addNo % m_restart == 0 )
+        Restart();
+
+    std::vector< double > g;
+    Gram( node, g );
+
+    const size_t H = m_in.size();
+    m_resNorm = sqrt( std::max( g[ ( H - 1 ) * H + ( H - 1 ) ], 0. ) );
+
+    try
+    {
+        if( m_engine == MixEngine_Broyden )
+            CoefBroyden( g );
+        else
+            CoefPulay( g );
+    }
+    catch( const std::runtime_error& )
+    {
+        // Residuals are linearly dependent, the linear mixing is applied
+        Restart();
+        m_d.assign( 1, 1. );
+    }
+}
+
+//
+// Removes all iterations, apart from the last one
+//
+void ScfMix::Restart()
+{
+    while( m_in.size() > 1 )
+    {
+        m_in.pop_front();
+        m_out.pop_front();
+    }
+}
+
+//
+// Calculates the matrix of scalar products of residuals g[ i * H + j ] = ( R_i, R_j ),
+// see item 5 in the header.
+//
+void ScfMix::Gram( const std::vector< double >& node, std::vector< double >& g ) const
+{
+    const size_t H = m_in.size();
+    const size_t Q = Gauss::Size();
+    const size_t N = ( node.size() - 1 ) * Q;
+
+    assert( node.size() >= 2 );
+
+    // Quadrature nodes and weights for all intervals
+    std::vector< double > r( N ), w( N );
+    for( size_t k = 0; k + 1 < node.size(); k++ )
+    {
+        const double p = 0.5 * ( node[ k + 1 ] - node[ k ] );
+        const double q = 0.5 * ( node[ k + 1 ] + node[ k ] );
+        for( size_t i = 0; i < Q; i++ )
+        {
+            r[ k * Q + i ] = p * Gauss::X( i ) + q;
+            w[ k * Q + i ] = p * Gauss::W( i );
+        }
+    }
+
+    // Residuals at the quadrature nodes
+    std::vector< double > res( H * N ), tmp( N );
+    for( size_t j = 0; j < H; j++ )
+    {
+        double* rj = &res[ j * N ];
+        m_out[ j ].Get( &r.front(), N, rj );
+        m_in[ j ].Get( &r.front(), N, &tmp.front() );
+        for( size_t i = 0; i < N; i++ )
+            rj[ i ] -= tmp[ i ];
+    }
+
+    g.assign( H * H, 0 );
+    for( size_t i = 0; i < H; i++ )
+    {
+        for( size_t j = i; j < H; j++ )
+        {
+            const double* ri = &res[ i * N ];
+            const double* rj = &res[ j * N ];
+            double sum = 0;
+            for( size_t k = 0; k < N; k++ )
+                sum += w[ k ] * ri[ k ] * rj[ k ];
+
+            g[ i * H + j ] = g[ j * H + i ] = sum;
+        }
+    }
+}
+
+//
+// DIIS coefficients. The constraint \sum_j d_j = 1 is eliminated by the differences
+// D_i = R_m - R_i (m - the last iteration), and the coefficients \theta_i minimize
+// the norm of R_m - \sum_i \theta_i D_i. Then d_i = \theta_i and d_m = 1 - \sum_i \theta_i.
+//
+void ScfMix::CoefPulay( const std::vector< double >& g )
+{
+    const size_t H = m_in.size();
+    const size_t m = H - 1;
+
+    m_d.assign( H, 0 );
+    m_d[ m ] = 1;
+    if( m == 0 )
+        return;
+
+    auto G = [ &g, H ]( size_t i, size_t j ) { return g[ i * H + j ]; };
+
+    ClpMtx a( m, m );
+    std::vector< double > b( m ), theta;
+    double diag = 0;
+    for( size_t i = 0; i < m; i++ )
+    {
+        for( size_t j = 0; j < m; j++ )
+            a.Set( i, j ) = G( m, m ) - G( m, i ) - G( m, j ) + G( i, j );
+
+        b[ i ] = G( m, m ) - G( i, m );
+        diag = std::max( diag, a.Get( i, i ) );
+    }
+
+    if( !( diag > 0 ) )
+        throw std::runtime_error( "Error in 'ScfMix::CoefPulay'" );
+
+    // Small regularization for nearly linearly dependent residuals
+    for( size_t i = 0; i < m; i++ )
+        a.Set( i, i ) += 1E-12 * diag;
+
+    a.Dsysv( b, theta );
+
+    for( size_t i = 0; i < m; i++ )
+    {
+        m_d[ i ] += theta[ i ];
+        m_d[ m ] -= theta[ i ];
+    }
+}
+
+//
+// Coefficients of modified Broyden method, see item 4 in the header.
+// With differences of consecutive iterations \Delta F_i = R_{i+1} - R_i (normalized),
+// the coefficients \gamma = ( w_0^2 I + A )^{-1} c, where A_{ki} = w_k w_i ( \Delta F_k, \Delta F_i )
+// and c_k = w_k ( \Delta F_k, R_m ). The new density is M_m - \sum_i g_i ( M_{i+1} - M_i ),
+// where g_i = w_i \gamma_i / |R_{i+1} - R_i|.
+//
+void ScfMix::CoefBroyden( const std::vector< double >& g )
+{
+    const size_t H = m_in.size();
+    const size_t m = H - 1;
+    const double w0 = 0.01;
+
+    m_d.assign( H, 0 );
+    m_d[ m ] = 1;
+    if( m == 0 )
+        return;
+
+    auto G = [ &g, H ]( size_t i, size_t j ) { return g[ i * H + j ]; };
+
+    // Norms of differences and weights
+    std::vector< double > norm( m ), w( m );
+    for( size_t i = 0; i < m; i++ )
+    {
+        norm[ i ] = sqrt( std::max( G( i + 1, i + 1 ) - 2 * G( i, i + 1 ) + G( i, i ), 0. ) );
+        const double ri = sqrt( std::max( G( i + 1, i + 1 ), 0. ) );
+        w[ i ] = ( ri > 0 ) ? m_resNorm / ri : 0;
+
+        if( !( norm[ i ] > 0 ) )
+            throw std::runtime_error( "Error in 'ScfMix::CoefBroyden'" );
+    }
+
+    // Scalar product of differences ( \Delta F_i, \Delta F_j ) and ( \Delta F_i, R_m ), not normalized
+    auto DD = [ &G ]( size_t i, size_t j ) { return G( i + 1, j + 1 ) - G( i + 1, j ) - G( i, j + 1 ) + G( i, j ); };
+    auto DR = [ &G, m ]( size_t i ) { return G( i + 1, m ) - G( i, m ); };
+
+    ClpMtx a( m, m );
+    std::vector< double > c( m ), gamma;
+    for( size_t k = 0; k < m; k++ )
+    {
+        for( size_t i = 0; i < m; i++ )
+            a.Set( k, i ) = w[ k ] * w[ i ] * DD( k, i ) / ( norm[ k ] * norm[ i ] );
+
+        a.Set( k, k ) += w0 * w0;
+        c[ k ] = w[ k ] * DR( k ) / norm[ k ];
+    }
+
+    a.Dsysv( c, gamma );
+
+    for( size_t i = 0; i < m; i++ )
+    {
+        const double gi = w[ i ] * gamma[ i ] / norm[ i ];
+        m_d[ i + 1 ] -= gi;
+        m_d[ i ] += gi;
+    }
+}
+
+//
+// Returns the new input electron density for radius "r"
+//
+double ScfMix::Get( double r ) const
+{
+    double val = 0;
+    for( size_t j = 0; j < m_d.size(); j++ )
+    {
+        if( m_d[ j ] == 0 )
+            continue;
+
+        val += m_d[ j ] * ( ( 1 - m_beta ) * m_in[ j ].Get( r ) + m_beta * m_out[ j ].Get( r ) );
+    }
+    return val;
+}
+
+//
+// Returns the new input electron density for radii r[0], ..., r[n-1]
+//
+void ScfMix::Get( const double* r, size_t n, double* val ) const
+{
+    std::vector< double > in( n ), out( n );
+    std::fill( val, val + n, 0. );
+
+    for( size_t j = 0; j < m_d.size(); j++ )
+    {
+        if( m_d[ j ] == 0 )
+            continue;
+
+        m_in[ j ].Get( r, n, &in.front() );
+        m_out[ j ].Get( r, n, &out.front() );
+
+        const double cIn = m_d[ j ] * ( 1 - m_beta );
+        const double cOut = m_d[ j ] * m_beta;
+        for( size_t i = 0; i < n; i++ )
+            val[ i ] += cIn * in[ i ] + cOut * out[ i ];
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef RATOM_SCFMIX_H
+#define RATOM_SCFMIX_H
+
+//
+// 1. Mixing of electron densities with history, used by the SCF procedure (see class NonLinKs),
+//    if parameter Scf_MixEngine is not "linear". For linear mixing see class RhoMix.
+//
+// 2. In SCF iteration "j" the input electron density \rho^{in}_j gives the output
+//    electron density \rho^{out}_j (calculated from the eigenfunctions).
+//    The residual is R_j = \rho^{out}_j - \rho^{in}_j.
+//
+// 3. The last Scf_MixHistory pairs (\rho^{in}_j, \rho^{out}_j) are stored as approximations
+//    (class Rho), which is the common representation of all densities. The output density
+//    is approximated starting from the nodes of the meshes of eigenvalue problems,
+//    where the eigenfunctions are polynomials.
+//
+// 4. The new input density is the combination
+//
+//        \rho = \sum_j d_j M_j,     M_j = ( 1 - \beta ) \rho^{in}_j + \beta \rho^{out}_j
+//
+//    where \beta = Scf_Mix, and the coefficients d_j (\sum_j d_j = 1) are defined by the engine:
+//       a) "pulay"    - DIIS: d_j minimize the norm of \sum_j d_j R_j,
+//       b) "anderson" - as "pulay", but only the last two iterations are used,
+//       c) "broyden"  - modified Broyden method of D. D. Johnson, Phys. Rev. B 38, 12807 (1988),
+//                       with weights w_i = |R_m| / |R_{i+1}| and w_0 = 0.01.
+//    For one stored iteration all engines give the linear mixing.
+//
+// 5. The scalar product of residuals is the integral \int_0^{R_c} R_i(r) R_j(r) dr,
+//    calculated by Gauss quadratures on the intervals between the nodes of the meshes
+//    of eigenvalue problems (they change, hence the products are calculated again
+//    in each SCF iteration).
+//
+// 6. The history is cleared (apart from the last iteration) every Scf_MixRestart iterations,
+//    or if the system of equations for the coefficients can not be solved.
+//
+// Zbigniew Romanowski [ROMZ@wp.pl]
+//
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+#include "fun1D.h"
+#include "rho.h"
+#include "config.h"
+
+
+class ScfMix : public Fun1D
+{
+public:
+    ScfMix();
+    virtual ~ScfMix() = default;
+
+    bool IsLinear() const { return m_engine == MixEngine_Linear; }
+    void Add( const Rho& rhoIn, const Fun1D& rhoOut, const std::vector< double >& node );
+
+    double Get( double r ) const override;
+    void Get( const double* r, size_t n, double* val ) const override;
+
+    size_t HistoryNo() const { return m_in.size(); }
+    double ResidualNorm() const { return m_resNorm; }
+
+private:
+    void Gram( const std::vector< double >& node, std::vector< double >& g ) const;
+    void CoefPulay( const std::vector< double >& g );
+    void CoefBroyden( const std::vector< double >& g );
+    void Restart();
+
+private:
+    // Engine, see parameter Scf_MixEngine
+    MixEngine m_engine;
+
+    // The maximal number of stored iterations and the period of restarts (0 - never)
+    size_t m_historyMax;
+    size_t m_restart;
+
+    // Mixing coefficient \beta
+    double m_beta;
+
+    // Input and output electron densities of the stored iterations (the last one is the newest)
+    std::deque< Rho > m_in;
+    std::deque< Rho > m_out;
+
+    // Coefficients d_j of the new density, see item 4 in the header
+    std::vector< double > m_d;
+
+    // Number of calls of function Add
+    size_t m_addNo;
+
+    // The norm of the last residual
+    double m_resNorm;
+};
+
+#endif
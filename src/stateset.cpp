@@ -1,23 +1,43 @@
 #include "stateset.h"
 #include "constants.h"
-#include "paramdb.h"
+#include "config.h"
 #include <stdexcept>
+#include <algorithm>
 
 // Initialization of static variable
 const StateDb StateSet::m_stateDb;
 std::vector< State > StateSet::m_state;
+std::vector< size_t > StateSet::m_nMax;
+std::vector< double > StateSet::m_occ;
+size_t StateSet::m_occStride = 0;
 
 //
 // Constructor
 //
 StateSet::StateSet( )
 {
-    const size_t proton = ParamDb::GetSize_t( "Atom_Proton" );
+    const size_t proton = Config::Get().m_proton;
 
     const std::vector< std::string > config = m_stateDb.GetConfig( proton );
 
     for( const std::string& v : config )
         m_state.push_back( State( v ) );
+
+    // Maximal quantum numbers, "l" without states has the value 1, see GetNmax
+    for( const State& s : m_state )
+    {
+        if( s.L() >= m_nMax.size() )
+            m_nMax.resize( s.L() + 1, 1 );
+
+        m_nMax[ s.L() ] = std::max( m_nMax[ s.L() ], s.N() + 1 );
+        m_occStride = std::max( m_occStride, s.N() + 1 );
+    }
+
+    // The occupation factors are looked up for each point of the radial mesh,
+    // hence they are stored in the dense table
+    m_occ.assign( m_nMax.size() * m_occStride, -1.0 );
+    for( const State& s : m_state )
+        m_occ[ s.L() * m_occStride + s.N() ] = s.Occ();
 }
 
 
@@ -41,7 +61,12 @@ const State& StateSet::Find( size_t l, size_t n )
 //
 double StateSet::Occ( size_t l, size_t n )
 {
-    return Find( l, n ).Occ();
+    const double occ = ( l < m_nMax.size() && n < m_occStride ) ? m_occ[ l * m_occStride + n ] : -1.0;
+
+    if( occ < 0 )
+        throw std::runtime_error( "Funtion 'StateSet::Occ': There is no state (n, l)" );
+
+    return occ;
 }
 
 //
@@ -53,41 +78,6 @@ std::string StateSet::Name( size_t l, size_t n )
 }
 
 
-//
-// Returns maximal angular quantum number
-//
-size_t StateSet::GetLmax()
-{
-size_t lMax = 0;
-
-    for( const State& s : m_state )
-    {
-        if( s.L() > lMax )
-            lMax = s.L();
-    }
-    return lMax + 1;
-}
-
-
-//
-// Returns maximum main quantum number of considered states
-// for given angular momentum number "l".
-//
-size_t StateSet::GetNmax( size_t l )
-{
-size_t nMax = 0;
-
-    for( const State& s : m_state )
-    {
-        if( s.L() != l )
-            continue;
-
-        if( s.N() > nMax )
-            nMax = s.N();
-    }
-    return nMax + 1;
-}
-
 //
 // Writes information about all states into file "out"
 //
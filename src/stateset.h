@@ -20,8 +20,9 @@ public:
     StateSet( );
     ~StateSet() = default;
 
-    static size_t GetLmax();
-    static size_t GetNmax(size_t l);
+    static size_t GetLmax() { return m_nMax.size(); }
+    // For "l" without states the value 1 is returned (as the search over all states did)
+    static size_t GetNmax(size_t l) { return ( l < m_nMax.size() ) ? m_nMax[l] : 1; }
 
     static double Occ(size_t l, size_t n);
     static std::string Name(size_t l, size_t n);
@@ -36,6 +37,14 @@ private:
     // Set of states
     static std::vector< State > m_state;
 
+    // Number of considered states "GetNmax(l)" for each angular quantum number "l"
+    static std::vector< size_t > m_nMax;
+
+    // Dense table of occupation factors, the factor of state (l, n) is
+    // m_occ[l * m_occStride + n]. Negative value means that there is no such state.
+    static std::vector< double > m_occ;
+    static size_t m_occStride;
+
     // The ground electronic configurations of the neutral elements
     const static StateDb m_stateDb;
 };
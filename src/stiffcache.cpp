@@ -0,0 +1,86 @@
+#include <algorithm>
+#include "stiffcache.h"
+
+
+//
+// Constructor
+//
+StiffCache::StiffCache( )
+    : m_capacity( 64 )
+    , m_clock( 0 )
+    , m_hitNo( 0 )
+    , m_missNo( 0 )
+{
+}
+
+//
+// Sets the maximal number of cached matrices.
+// At least one matrix is always cached.
+//
+void StiffCache::SetCapacity( size_t capacity )
+{
+    m_capacity = std::max( capacity, size_t( 1 ) );
+
+    while( m_entry.size() > m_capacity )
+    {
+        size_t oldest = 0;
+        for( size_t i = 1; i < m_entry.size(); i++ )
+        {
+            if( m_entry[ i ].m_stamp < m_entry[ oldest ].m_stamp )
+                oldest = i;
+        }
+        m_entry.erase( m_entry.begin() + oldest );
+    }
+}
+
+//
+// Returns the identifier of the entry for mesh "mesh".
+// If there is no such entry, NOT_FOUND is returned.
+//
+size_t StiffCache::Find( const Mesh& mesh )
+{
+    for( size_t i = 0; i < m_entry.size(); i++ )
+    {
+        if( m_entry[ i ].m_mesh.IsSame( mesh ) )
+        {
+            m_entry[ i ].m_stamp = ++m_clock;
+            m_hitNo++;
+            return i;
+        }
+    }
+
+    m_missNo++;
+    return NOT_FOUND;
+}
+
+//
+// Factorizes the stiffness matrix "s" assembled for mesh "mesh" and stores it in the cache.
+// Returns the identifier of the new entry.
+//
+size_t StiffCache::Add( const Mesh& mesh, const ClpMtxBand& s )
+{
+    size_t id = m_entry.size();
+
+    if( m_entry.size() >= m_capacity )
+    {
+        // Replace the least recently used entry
+        id = 0;
+        for( size_t i = 1; i < m_entry.size(); i++ )
+        {
+            if( m_entry[ i ].m_stamp < m_entry[ id ].m_stamp )
+                id = i;
+        }
+    }
+    else
+    {
+        m_entry.emplace_back();
+    }
+
+    Entry& e = m_entry[ id ];
+    e.m_mesh = mesh;
+    e.m_s = s;
+    e.m_chol.Factor( s );
+    e.m_stamp = ++m_clock;
+
+    return id;
+}
@@ -0,0 +1,78 @@
+#ifndef RATOM_STIFFCACHE_H
+#define RATOM_STIFFCACHE_H
+
+//
+// 1. Cache of the assembled and factorized stiffness matrices.
+//
+// 2. The stiffness matrix of the Poisson equation depends on the mesh only,
+//    it does not depend on the electron density. Hence, it is assembled and factorized
+//    once for each mesh. Next time the same mesh is used, the cached factorization is reused
+//    and only the load vector must be assembled.
+//
+// 3. The mesh is the key of the cache. The meshes are equal if they have the same nodes
+//    and the same degrees of elements, see function Mesh::IsSame.
+//    The boundary conditions must be the same for all meshes in the cache.
+//
+// 4. The number of cached matrices is limited. If the cache is full,
+//    the least recently used entry is removed.
+//
+// Zbigniew Romanowski [ROMZ@wp.pl]
+//
+
+#include <cstddef>
+#include <vector>
+#include "mesh.h"
+#include "clpmtxband.h"
+#include "clpcholband.h"
+
+
+class StiffCache
+{
+public:
+    StiffCache();
+    ~StiffCache() = default;
+
+    void SetCapacity( size_t capacity );
+    size_t Find( const Mesh& mesh );
+    size_t Add( const Mesh& mesh, const ClpMtxBand& s );
+
+    const ClpMtxBand& Mtx( size_t id ) const { return m_entry[ id ].m_s; }
+    const ClpCholBand& Chol( size_t id ) const { return m_entry[ id ].m_chol; }
+
+    size_t Size() const { return m_entry.size(); }
+    size_t HitNo() const { return m_hitNo; }
+    size_t MissNo() const { return m_missNo; }
+
+    static const size_t NOT_FOUND = static_cast< size_t >( -1 );
+
+private:
+    struct Entry
+    {
+        // Mesh for which the stiffness matrix was assembled
+        Mesh m_mesh;
+
+        // Assembled stiffness matrix
+        ClpMtxBand m_s;
+
+        // Cholesky factorization of the stiffness matrix
+        ClpCholBand m_chol;
+
+        // Time of the last usage
+        size_t m_stamp;
+    };
+
+    // Cached entries
+    std::vector< Entry > m_entry;
+
+    // Maximal number of entries
+    size_t m_capacity;
+
+    // Counter incremented on each access, used to find the least recently used entry
+    size_t m_clock;
+
+    // Statistics
+    size_t m_hitNo;
+    size_t m_missNo;
+};
+
+#endif